@@ -4,6 +4,8 @@
 #include <TH2D.h>
 #include <iostream>
 
+#include "../../Utils/CEffTable.hh"
+
 class CEffUser2D
 {
 public:
@@ -14,17 +16,20 @@ public:
   Float_t getEff(const Double_t x, const Double_t y);
   Float_t getErrLow(const Double_t x, const Double_t y);
   Float_t getErrHigh(const Double_t x, const Double_t y);    
+  Bool_t  getSF(const Double_t x, const Double_t y, Float_t &eff, Float_t &errl, Float_t &errh);
+  void    getSF(const UInt_t n, const Double_t *x, const Double_t *y, Float_t *out);
   void    printEff(std::ostream& os);
   void    printErrLow(std::ostream& os);
   void    printErrHigh(std::ostream& os);
 
 protected:
   void    printHist2D(const TH2D* h,std::ostream& os);
-  Float_t getValue(const TH2D* h, const Double_t x, const Double_t y);
 
   TH2D *hEff;
   TH2D *hErrl;
   TH2D *hErrh;
+
+  CEffTable table;  // flat copy of the three tables for the lookups
 };
 
 #endif
@@ -0,0 +1,151 @@
+#ifndef CTOYSTORE_HH
+#define CTOYSTORE_HH
+
+#include <TH1D.h>                   // 1D histograms
+#include <TString.h>                // ROOT string class
+#include <RooAbsData.h>             // RooFit data set base class
+#include <RooArgSet.h>              // RooFit set of variables
+#include <vector>                   // STL vector class
+#include <cstdio>                   // C file I/O
+#include <cstring>                  // memcmp, memcpy
+#include <cassert>                  // assertions
+#include <fcntl.h>                  // open
+#include <unistd.h>                 // close
+#include <sys/mman.h>               // mmap
+#include <sys/stat.h>               // fstat
+
+//
+// binary columnar store of the pseudo-experiments of one bin
+//
+//  * one file per bin holds all toys, instead of one text file per toy
+//  * layout: header (magic, version, number of toys, number of entries), toy offsets
+//    (nToys+1 entries), then the mass column (Float_t) and the state column (UChar_t, the
+//    "sample" category index: 1 = pass, 2 = fail), toys stored one after the other
+//  * CToyWriter collects toys in memory and writes the file at the end
+//  * CToyStore maps the file read-only, so reading a toy is a pointer lookup
+//
+namespace toystore {
+  const char     kMagic[4] = { 'T','O','Y','S' };
+  const UInt_t   kVersion  = 1;
+
+  struct Header
+  {
+    char      magic[4];
+    UInt_t    version;
+    UInt_t    nToys;
+    UInt_t    pad;
+    ULong64_t nEntries;
+  };
+}
+
+class CToyWriter
+{
+public:
+  CToyWriter() { fOffsetv.push_back(0); }
+  ~CToyWriter(){}
+
+  // add one entry to the current toy
+  void fill(const Float_t m, const UChar_t state) {
+    fMassv.push_back(m);
+    fStatev.push_back(state);
+  }
+
+  // add the entries of a generated data set (mass variable and pass/fail category) as a new toy
+  void addToy(const RooAbsData &data, const char *mname="m", const char *catname="sample") {
+    for(Int_t i=0; i<data.numEntries(); i++) {
+      const RooArgSet *row = data.get(i);
+      fill(row->getRealValue(mname), row->getCatIndex(catname));
+    }
+    endToy();
+  }
+
+  // close the current toy
+  void endToy() { fOffsetv.push_back(fMassv.size()); }
+
+  UInt_t nToys() const { return fOffsetv.size()-1; }
+
+  Bool_t write(const TString &fname) const {
+    toystore::Header header;
+    memcpy(header.magic, toystore::kMagic, sizeof(header.magic));
+    header.version  = toystore::kVersion;
+    header.nToys    = nToys();
+    header.pad      = 0;
+    header.nEntries = fMassv.size();
+
+    FILE *fp = fopen(fname.Data(),"wb");
+    if(!fp) return kFALSE;
+    Bool_t ok = (fwrite(&header, sizeof(header), 1, fp)==1);
+    ok = ok && (fwrite(&fOffsetv[0], sizeof(ULong64_t), fOffsetv.size(), fp)==fOffsetv.size());
+    if(header.nEntries>0) {
+      ok = ok && (fwrite(&fMassv[0],  sizeof(Float_t), fMassv.size(),  fp)==fMassv.size());
+      ok = ok && (fwrite(&fStatev[0], sizeof(UChar_t), fStatev.size(), fp)==fStatev.size());
+    }
+    return (fclose(fp)==0) && ok;
+  }
+
+protected:
+  std::vector<ULong64_t> fOffsetv;  // first entry of each toy (plus total)
+  std::vector<Float_t>   fMassv;    // masses
+  std::vector<UChar_t>   fStatev;   // pass/fail states
+};
+
+class CToyStore
+{
+public:
+  CToyStore(const TString &fname):fBuf(0),fSize(0),fHeader(0),fOffsets(0),fMass(0),fState(0)
+  {
+    const int fd = open(fname.Data(), O_RDONLY);
+    assert(fd>=0);
+    struct stat st;
+    const int status = fstat(fd,&st);
+    assert(status==0);
+    fSize = st.st_size;
+    assert(fSize >= sizeof(toystore::Header));
+    fBuf = mmap(0, fSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    assert(fBuf!=MAP_FAILED);
+
+    const char *p = (const char*)fBuf;
+    fHeader = (const toystore::Header*)p;
+    assert(memcmp(fHeader->magic, toystore::kMagic, sizeof(toystore::kMagic))==0);
+    assert(fHeader->version==toystore::kVersion);
+    p += sizeof(toystore::Header);
+    fOffsets = (const ULong64_t*)p;
+    p += (fHeader->nToys+1)*sizeof(ULong64_t);
+    fMass  = (const Float_t*)p;
+    p += fHeader->nEntries*sizeof(Float_t);
+    fState = (const UChar_t*)p;
+    p += fHeader->nEntries*sizeof(UChar_t);
+    assert(size_t(p - (const char*)fBuf) == fSize);
+    assert(fOffsets[fHeader->nToys] == fHeader->nEntries);
+  }
+  ~CToyStore() { munmap(fBuf,fSize); }
+
+  UInt_t         nToys()                   const { return fHeader->nToys; }
+  UInt_t         size(const UInt_t itoy)   const { assert(itoy<nToys()); return fOffsets[itoy+1]-fOffsets[itoy]; }
+  const Float_t* masses(const UInt_t itoy) const { assert(itoy<nToys()); return fMass  + fOffsets[itoy]; }
+  const UChar_t* states(const UInt_t itoy) const { assert(itoy<nToys()); return fState + fOffsets[itoy]; }
+
+  // fill pass (state 1) and fail (state 2) mass histograms of a toy
+  void fillHists(const UInt_t itoy, TH1D *hPass, TH1D *hFail) const {
+    const Float_t *m = masses(itoy);
+    const UChar_t *s = states(itoy);
+    for(UInt_t i=0; i<size(itoy); i++) {
+      if     (s[i]==1) hPass->Fill(m[i]);
+      else if(s[i]==2) hFail->Fill(m[i]);
+    }
+  }
+
+protected:
+  CToyStore(const CToyStore&);             // not copyable (owns the mapping)
+  CToyStore& operator=(const CToyStore&);
+
+  void                     *fBuf;      // mapped file
+  size_t                    fSize;     // file size
+  const toystore::Header   *fHeader;   // file header
+  const ULong64_t          *fOffsets;  // first entry of each toy (plus total)
+  const Float_t            *fMass;     // mass column
+  const UChar_t            *fState;    // pass/fail state column
+};
+
+#endif
@@ -0,0 +1,91 @@
+/*****************************************************************************
+ * Description:
+ *   Histogram template convolved with a Gaussian in closed form, see
+ *   RooGaussSmearedHist.h
+ *****************************************************************************/
+
+#include "RooGaussSmearedHist.h"
+#include "TMath.h"
+#include <algorithm>
+#include <cassert>
+
+ClassImp(RooGaussSmearedHist)
+
+// number of sigmas beyond which the Gaussian tails are neglected
+static const Double_t kNSigmaMax = 8;
+
+// cumulative Gaussian and its integral (z*Phi(z) + phi(z))
+static inline Double_t gausCdf(const Double_t z)    { return 0.5*TMath::Erfc(-z*TMath::Sqrt1_2()); }
+static inline Double_t gausCdfInt(const Double_t z) { return z*gausCdf(z) + TMath::Exp(-0.5*z*z)/TMath::Sqrt(TMath::TwoPi()); }
+
+RooGaussSmearedHist::RooGaussSmearedHist(const char *name, const char *title,
+					 RooAbsReal& _x,
+					 RooAbsReal& _mean,
+					 RooAbsReal& _sigma,
+					 const TH1D& hist) :
+  RooAbsPdf(name,title),
+  x("x","x",this,_x),
+  mean("mean","mean",this,_mean),
+  sigma("sigma","sigma",this,_sigma)
+{
+  const Int_t nbins = hist.GetNbinsX();
+  for(Int_t i=1; i<=nbins+1; i++) edges.push_back(hist.GetXaxis()->GetBinLowEdge(i));
+  for(Int_t i=1; i<=nbins; i++)   density.push_back(std::max(hist.GetBinContent(i),0.)/hist.GetXaxis()->GetBinWidth(i));
+}
+
+RooGaussSmearedHist::RooGaussSmearedHist(const RooGaussSmearedHist& other, const char* name) :
+  RooAbsPdf(other,name),
+  x("x",this,other.x),
+  mean("mean",this,other.mean),
+  sigma("sigma",this,other.sigma),
+  edges(other.edges),
+  density(other.density)
+{ }
+
+// Gaussian width, kept away from 0 (sigma ranges start at 0)
+Double_t RooGaussSmearedHist::width() const
+{
+  return std::max(Double_t(sigma), 1e-6*(edges.back()-edges.front()));
+}
+
+// first template bin with upper edge above t
+Int_t RooGaussSmearedHist::firstBin(const Double_t t) const
+{
+  return std::upper_bound(edges.begin()+1, edges.end(), t) - (edges.begin()+1);
+}
+
+Double_t RooGaussSmearedHist::evaluate() const
+{
+  const Double_t s = width();
+  const Double_t t = x - mean;
+  const Int_t    n = density.size();
+
+  Double_t val = 0;
+  for(Int_t i=firstBin(t - kNSigmaMax*s); i<n && edges[i] < t + kNSigmaMax*s; i++) {
+    val += density[i]*(gausCdf((t-edges[i])/s) - gausCdf((t-edges[i+1])/s));
+  }
+  return val;
+}
+
+Int_t RooGaussSmearedHist::getAnalyticalIntegral(RooArgSet& allVars, RooArgSet& analVars, const char* /*rangeName*/) const
+{
+  if(matchArgs(allVars,analVars,x)) return 1;
+  return 0;
+}
+
+Double_t RooGaussSmearedHist::analyticalIntegral(Int_t code, const char* rangeName) const
+{
+  assert(code==1);
+  const Double_t s  = width();
+  const Double_t ta = x.min(rangeName) - mean;
+  const Double_t tb = x.max(rangeName) - mean;
+
+  // integral over [a,b] of bin i: sigma*[ Psi((tb-e_i)/s) - Psi((tb-e_i+1)/s) - Psi((ta-e_i)/s) + Psi((ta-e_i+1)/s) ]
+  Double_t val = 0;
+  for(UInt_t i=0; i<density.size(); i++) {
+    if(density[i]==0) continue;
+    val += density[i]*(gausCdfInt((tb-edges[i])/s) - gausCdfInt((tb-edges[i+1])/s)
+                       - gausCdfInt((ta-edges[i])/s) + gausCdfInt((ta-edges[i+1])/s));
+  }
+  return s*val;
+}
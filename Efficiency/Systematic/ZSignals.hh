@@ -11,21 +11,30 @@
 #include "RooHistPdf.h"
 #include "RooVoigtianShape.h"
 #include "RooKeysPdf.h"
+#include "RooGaussSmearedHist.h"
+#include "TMath.h"
 
 class CSignalModel
 {
 public:
   CSignalModel():model(0){}
   virtual ~CSignalModel(){ delete model; }
+  virtual Double_t fftScale() const { return 0; }  // smallest width the FFT grid has to resolve (0 if no FFT)
   RooAbsPdf *model;
 };
 
+// Sets the FFT sampling grid ("cache" binning of m) of the RooFFTConvPdf models to ~5 points per
+// fftScale(), as a power of 2 and at most 10000 points. Without FFT models the default binning is kept.
+void setConvBins(RooRealVar &m, const CSignalModel *sig1, const CSignalModel *sig2);
+void setConvBins(RooRealVar &m, const Double_t scale);  // same, for RooFFTConvPdf built outside CSignalModel
+
 class CBreitWignerConvCrystalBall : public CSignalModel
 {
 public:
   CBreitWignerConvCrystalBall(RooRealVar &m, const Bool_t pass);
   CBreitWignerConvCrystalBall(RooRealVar &m, const Bool_t pass, Double_t massVal, Double_t widthVal, Double_t meanVal, Double_t sigmaVal, Double_t alphaVal, Double_t nVal);
   ~CBreitWignerConvCrystalBall();
+  Double_t fftScale() const { return TMath::Max(sigma->getMin(), 0.5*sigma->getVal()); }
   RooRealVar     *mass, *width;
   RooBreitWigner *bw;
   RooRealVar     *mean, *sigma, *alpha, *n;
@@ -35,13 +44,10 @@ public:
 class CMCTemplateConvGaussian : public CSignalModel
 {
 public:
-  CMCTemplateConvGaussian(RooRealVar &m, TH1D* hist, const Bool_t pass, RooRealVar *sigma0=0, int intOrder=1);
+  CMCTemplateConvGaussian(RooRealVar &m, TH1D* hist, const Bool_t pass, RooRealVar *sigma0=0);
   ~CMCTemplateConvGaussian();
   RooRealVar  *mean, *sigma;
-  RooGaussian *gaus;
   TH1D        *inHist;
-  RooDataHist *dataHist;
-  RooHistPdf  *histPdf;
 };
 
 class CVoigtianCBShape : public CSignalModel
@@ -58,6 +64,7 @@ class CMCDatasetConvGaussian : public CSignalModel
 public:
   CMCDatasetConvGaussian(RooRealVar &m, TTree* tree, const Bool_t pass, RooRealVar *sigma0=0);
   ~CMCDatasetConvGaussian();
+  Double_t fftScale() const { return TMath::Max(sigma->getMin(), 0.5*sigma->getVal()); }
   RooRealVar  *mean, *sigma;
   RooGaussian *gaus;
   TTree       *inTree;
@@ -65,6 +72,24 @@ public:
   RooKeysPdf  *keysPdf;
 };
 
+//--------------------------------------------------------------------------------------------------
+void setConvBins(RooRealVar &m, const CSignalModel *sig1, const CSignalModel *sig2)
+{
+  Double_t scale = 0;
+  if(sig1 && sig1->fftScale()>0) scale = sig1->fftScale();
+  if(sig2 && sig2->fftScale()>0) scale = (scale>0) ? TMath::Min(scale,sig2->fftScale()) : sig2->fftScale();
+  setConvBins(m,scale);
+}
+
+void setConvBins(RooRealVar &m, const Double_t scale)
+{
+  if(scale<=0) return;
+  
+  Int_t nbins = 256;
+  while(nbins<10000 && (m.getMax()-m.getMin())/nbins > 0.2*scale) nbins *= 2;
+  m.setBins(TMath::Min(nbins,10000),"cache");
+}
+
 //--------------------------------------------------------------------------------------------------
 CBreitWignerConvCrystalBall::CBreitWignerConvCrystalBall(RooRealVar &m, const Bool_t pass)
 {
@@ -173,7 +198,7 @@ CBreitWignerConvCrystalBall::~CBreitWignerConvCrystalBall()
 }
 
 //--------------------------------------------------------------------------------------------------
-CMCTemplateConvGaussian::CMCTemplateConvGaussian(RooRealVar &m, TH1D* hist, const Bool_t pass, RooRealVar *sigma0, int intOrder)
+CMCTemplateConvGaussian::CMCTemplateConvGaussian(RooRealVar &m, TH1D* hist, const Bool_t pass, RooRealVar *sigma0)
 {  
   char name[10];
   if(pass) sprintf(name,"%s","Pass");
@@ -181,35 +206,22 @@ CMCTemplateConvGaussian::CMCTemplateConvGaussian(RooRealVar &m, TH1D* hist, cons
   
   char vname[50];  
   
-  if(pass) {
-    sprintf(vname,"mean%s",name);  mean  = new RooRealVar(vname,vname,0,-10,10);
-    if(sigma0) { sigma = sigma0; }
-    else       { sprintf(vname,"sigma%s",name); sigma = new RooRealVar(vname,vname,2,0,5); }
-    sprintf(vname,"gaus%s",name);  gaus  = new RooGaussian(vname,vname,m,*mean,*sigma);
-  } else {
-    sprintf(vname,"mean%s",name);  mean  = new RooRealVar(vname,vname,0,-10,10);
-    if(sigma0) { sigma = sigma0; }
-    else       { sprintf(vname,"sigma%s",name); sigma = new RooRealVar(vname,vname,2,0,5); }
-    sprintf(vname,"gaus%s",name);  gaus  = new RooGaussian(vname,vname,m,*mean,*sigma);
-  }
-
+  sprintf(vname,"mean%s",name);  mean  = new RooRealVar(vname,vname,0,-10,10);
+  if(sigma0) { sigma = sigma0; }
+  else       { sprintf(vname,"sigma%s",name); sigma = new RooRealVar(vname,vname,2,0,5); }
 
   sprintf(vname,"inHist_%s",hist->GetName());
   inHist = (TH1D*)hist->Clone(vname);
   
-  sprintf(vname,"dataHist%s",name); dataHist = new RooDataHist(vname,vname,RooArgSet(m),inHist);
-  sprintf(vname,"histPdf%s",name);  histPdf  = new RooHistPdf(vname,vname,m,*dataHist,intOrder);
-  sprintf(vname,"signal%s",name);   model    = new RooFFTConvPdf(vname,vname,m,*histPdf,*gaus);
+  // template smeared by the Gaussian in closed form (no FFT grid)
+  sprintf(vname,"signal%s",name);   model    = new RooGaussSmearedHist(vname,vname,m,*mean,*sigma,*inHist);
 }
 
 CMCTemplateConvGaussian::~CMCTemplateConvGaussian()
 {
   delete mean;
   //delete sigma;
-  delete gaus;
   delete inHist;
-  delete dataHist;
-  delete histPdf;
 }
 
 //--------------------------------------------------------------------------------------------------
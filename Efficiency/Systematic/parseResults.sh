@@ -5,8 +5,15 @@ for x in 9
 do
   echo $x
 
-  #ls /scratch/klawhorn/EffSysStore/CB_MuSelEffResults/etapt_$x_*output 
-  cat /scratch/klawhorn/EffSysStore/${effType}Results/etapt_${x}_*output | grep eff | awk '{ print $3 }' > ${effType}_BinUncert/etapt_${x}.dat
+  # table of all toys of the bin (doPseudoFits.C on a .toys store), else one .output file per toy
+  table=/scratch/klawhorn/EffSysStore/${effType}Results/etapt_${x}_toys.txt
+  if [ -f $table ]
+  then
+    grep -v '^#' $table | awk '{ print $2 }' > ${effType}_BinUncert/etapt_${x}.dat
+  else
+    #ls /scratch/klawhorn/EffSysStore/CB_MuSelEffResults/etapt_$x_*output 
+    cat /scratch/klawhorn/EffSysStore/${effType}Results/etapt_${x}_*output | grep eff | awk '{ print $3 }' > ${effType}_BinUncert/etapt_${x}.dat
+  fi
   #grep "Full" /scratch/klawhorn/EffSysStore/${effType}Results/etapt_${x}_*output |wc
 
 done
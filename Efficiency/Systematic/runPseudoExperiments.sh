@@ -9,6 +9,7 @@
   outputDir=$9
      charge=${10}
  mcfilename=${11}
+       itoy=${12:--1}
 
 h=`basename $0`
 echo "Script:    $h"
@@ -53,11 +54,11 @@ echo " "; echo "${h}: Starting root job now"; echo " ";
 
 source /scratch/ksung/ROOT/root/bin/thisroot.sh
 
-echo "root -l -q -b rootlogon.C doPseudoFits.C+\(\"$pseudoDir/$pseudoType\",\"$file\",\"$RUNDIR/$pseudoType/analysis/plots/$binNumber.root\",$sigPassFit,$bkgPassFit,$sigFailFit,$bkgFailFit,\"$outputDir\",$charge,\"$mcfilename\"\)"
+echo "root -l -q -b rootlogon.C doPseudoFits.C+\(\"$pseudoDir/$pseudoType\",\"$file\",\"$RUNDIR/$pseudoType/analysis/plots/$binNumber.root\",$sigPassFit,$bkgPassFit,$sigFailFit,$bkgFailFit,\"$outputDir\",$charge,\"$mcfilename\",$itoy\)"
 
-#root -l -q -b rootlogon.C doPseudoFits.C+\(\"$pseudoDir/$pseudoType\",\"$file\",\"$RUNDIR/$pseudoType/analysis/plots/$binNumber.root\",$sigPassFit,$bkgPassFit,$sigFailFit,$bkgFailFit,\"$outputDir\",$charge,\"$mcfilename\"\)
+#root -l -q -b rootlogon.C doPseudoFits.C+\(\"$pseudoDir/$pseudoType\",\"$file\",\"$RUNDIR/$pseudoType/analysis/plots/$binNumber.root\",$sigPassFit,$bkgPassFit,$sigFailFit,$bkgFailFit,\"$outputDir\",$charge,\"$mcfilename\",$itoy\)
 
-root -l -q -b rootlogon.C doPseudoFits.C+\(\"$pseudoDir/$pseudoType\",\"$file\",\"$RUNDIR/$pseudoType/analysis/plots/$binNumber.root\",$sigPassFit,$bkgPassFit,$sigFailFit,$bkgFailFit,\"$outputDir\",$charge,\"$mcfilename\"\)
+root -l -q -b rootlogon.C doPseudoFits.C+\(\"$pseudoDir/$pseudoType\",\"$file\",\"$RUNDIR/$pseudoType/analysis/plots/$binNumber.root\",$sigPassFit,$bkgPassFit,$sigFailFit,$bkgFailFit,\"$outputDir\",$charge,\"$mcfilename\",$itoy\)
 
 # get the return code from the root job
 status=`echo $?`
@@ -11,8 +11,12 @@ echo "  --> $*"
   outputDir=$8
      charge=$9
  mcfilename=${10}
+      nToys=${11}
 #
-# ./submitPseudoExperiments.sh /scratch/klawhorn/EffSysStore CB_MuSelEff etapt_6 2 1 2 1 /scratch/klawhorn/EffSysStore/CB_MuSelEffResults 0 /scratch/klawhorn/EWKAnaR12a/Efficiency/Zmm_MuSelEff/probes.root
+# ./submitPseudoExperiments.sh /scratch/klawhorn/EffSysStore CB_MuSelEff etapt_6 2 1 2 1 /scratch/klawhorn/EffSysStore/CB_MuSelEffResults 0 /scratch/klawhorn/EWKAnaR12a/Efficiency/Zmm_MuSelEff/probes.root 1000
+#
+# with a store <binNumber>.toys: one job fitting all toys of the bin (no nToys given), or one job per toy
+# 0..nToys-1; with text files (old format): one job per file
 #
 
 jobId=`date +%j%m%d%k%M%S`
@@ -48,32 +52,54 @@ fi
 echo
 echo
 
-for file in `ls $pseudoDir/$pseudoType/ | grep ^${binNumber}_`
+if [ -f $pseudoDir/$pseudoType/${binNumber}.toys ] && [ -z "$nToys" ]
+then
+  jobs="${binNumber}.toys:-1"
+elif [ -f $pseudoDir/$pseudoType/${binNumber}.toys ]
+then
+  jobs=`seq -f "${binNumber}.toys:%g" 0 $(($nToys-1))`
+else
+  jobs=`ls $pseudoDir/$pseudoType/ | grep ^${binNumber}_ | sed 's/$/:-1/'`
+fi
+
+for job in $jobs
 do
 
-  echo $file
+  file=${job%:*}
+  itoy=${job##*:}
+  if [ $itoy -ge 0 ]
+  then
+    jobName=`printf "%s_%04d" $binNumber $itoy`
+  elif [ "$file" == "${binNumber}.toys" ]
+  then
+    jobName=${binNumber}_toys
+  else
+    jobName=$file
+  fi
+
+  echo $jobName
 
-  logFile=`echo $file | tr '/' '+'`
+  logFile=`echo $jobName | tr '/' '+'`
   logFile=/tmp/$USER/$logFile
   mkdir -p /tmp/$USER
   rm    -f $logFile
 
-  echo "runPseudoExperiments.sh $file $pseudoDir $pseudoType $binNumber $sigPassFit $bkgPassFit $sigFailFit $bkgFailFit $outputDir $charge $mcfilename  "
+  echo "runPseudoExperiments.sh $file $pseudoDir $pseudoType $binNumber $sigPassFit $bkgPassFit $sigFailFit $bkgFailFit $outputDir $charge $mcfilename $itoy "
 
-  #./runPseudoExperiments.sh $file $pseudoDir $pseudoType $binNumber $sigPassFit $bkgPassFit $sigFailFit $bkgFailFit $outputDir $charge $mcfilename
+  #./runPseudoExperiments.sh $file $pseudoDir $pseudoType $binNumber $sigPassFit $bkgPassFit $sigFailFit $bkgFailFit $outputDir $charge $mcfilename $itoy
 
 cat > submit.cmd <<EOF
 Universe                = vanilla
 Requirements            = ((Arch == "X86_64") && (Machine != "t3btch112.mit.edu") && (Disk >= DiskUsage) && ((Memory * 1024) >= ImageSize) && (HasFileTransfer))
 Notification            = Error
 Executable              = runPseudoExperiments.sh
-Arguments               = $file $pseudoDir $pseudoType $binNumber $sigPassFit $bkgPassFit $sigFailFit $bkgFailFit $outputDir $charge $mcfilename
+Arguments               = $file $pseudoDir $pseudoType $binNumber $sigPassFit $bkgPassFit $sigFailFit $bkgFailFit $outputDir $charge $mcfilename $itoy
 Rank                    = Mips
 GetEnv                  = True
 Initialdir              = $workDir
 Input                   = /dev/null
-Output                  = ${outputDir}/${file}.out
-Error                   = ${outputDir}/${file}.err
+Output                  = ${outputDir}/${jobName}.out
+Error                   = ${outputDir}/${jobName}.err
 Log                     = $logFile
 should_transfer_files   = YES
 when_to_transfer_output = ON_EXIT
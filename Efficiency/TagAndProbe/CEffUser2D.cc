@@ -12,6 +12,7 @@ void CEffUser2D::loadEff(TH2D* eff, TH2D* errl, TH2D* errh)
   hEff = eff;
   hErrl = errl;
   hErrh = errh;
+  table.load(hEff,hErrl,hErrh);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -21,7 +22,7 @@ Float_t CEffUser2D::getEff(const Double_t x, const Double_t y)
     cout << "Efficiency table not loaded! Aborting..." << endl;
     assert(0);
   }
-  return getValue(hEff,x,y);
+  return table.get(x,y,CEffTable::kEff);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -31,7 +32,7 @@ Float_t CEffUser2D::getErrLow(const Double_t x, const Double_t y)
     cout << "Low errors table not loaded! Aborting..." << endl;
     assert(0);
   }
-  return getValue(hErrl,x,y);
+  return table.get(x,y,CEffTable::kErrl);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -41,7 +42,27 @@ Float_t CEffUser2D::getErrHigh(const Double_t x, const Double_t y)
     cout << "High errors table not loaded! Aborting..." << endl;
     assert(0);
   }
-  return getValue(hErrh,x,y);
+  return table.get(x,y,CEffTable::kErrh);
+}
+
+//--------------------------------------------------------------------------------------------------
+Bool_t CEffUser2D::getSF(const Double_t x, const Double_t y, Float_t &eff, Float_t &errl, Float_t &errh)
+{
+  if(!(hEff && hErrl && hErrh)) {
+    cout << "Not all tables loaded! Aborting..." << endl;
+    assert(0);
+  }
+  return table.getSF(x,y,eff,errl,errh);
+}
+
+//--------------------------------------------------------------------------------------------------
+void CEffUser2D::getSF(const UInt_t n, const Double_t *x, const Double_t *y, Float_t *out)
+{
+  if(!(hEff && hErrl && hErrh)) {
+    cout << "Not all tables loaded! Aborting..." << endl;
+    assert(0);
+  }
+  table.getSF(n,x,y,out);
 }
 
 //--------------------------------------------------------------------------------------------------  
@@ -138,31 +159,3 @@ void CEffUser2D::printHist2D(const TH2D* h, ostream& os) {
     os << endl;
   }
 }
-
-//--------------------------------------------------------------------------------------------------
-Float_t CEffUser2D::getValue(const TH2D* h, const Double_t x, const Double_t y)
-{
-  Int_t ix=0;
-  Int_t iy=0;
-  const Int_t nx = h->GetNbinsX();
-  const Int_t ny = h->GetNbinsY();
-  
-  for(Int_t i=1; i<=nx; i++) {
-    if((x >= h->GetXaxis()->GetBinLowEdge(i)) && (x < h->GetXaxis()->GetBinLowEdge(i+1))) {
-      ix=i;
-      break;
-    }
-  }
-  
-  for(Int_t i=1; i<=ny; i++) {
-    if((y >= h->GetYaxis()->GetBinLowEdge(i)) && (y < h->GetYaxis()->GetBinLowEdge(i+1))) {
-      iy=i;
-      break;
-    }
-  }
-  
-  if(ix>0 && iy>0)
-    return h->GetBinContent(h->GetBin(ix,iy));
-  else 
-    return -1;
-}
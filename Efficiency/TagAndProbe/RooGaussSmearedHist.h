@@ -0,0 +1,54 @@
+/*****************************************************************************
+ * Description:
+ *   Histogram template (piecewise constant density) convolved with a
+ *   Gaussian of floating mean and width, in closed form. Replaces the
+ *   RooFFTConvPdf of RooHistPdf x RooGaussian for MC template signal models:
+ *
+ *     f(x) = sum_i d_i * [ Phi((x-mean-e_i)/sigma) - Phi((x-mean-e_{i+1})/sigma) ]
+ *
+ *   with d_i = content/width of template bin [e_i,e_{i+1}]. Only template bins
+ *   within +-8 sigma of x-mean are summed, and the integral over x is analytic,
+ *   so a change of mean or sigma costs no FFT and no sampling grid.
+ *****************************************************************************/
+
+#ifndef ROO_GAUSS_SMEARED_HIST
+#define ROO_GAUSS_SMEARED_HIST
+
+#include "RooAbsPdf.h"
+#include "RooRealProxy.h"
+#include "RooAbsReal.h"
+#include "TH1D.h"
+#include <vector>
+
+class RooGaussSmearedHist : public RooAbsPdf {
+public:
+  RooGaussSmearedHist() {}
+  RooGaussSmearedHist(const char *name, const char *title,
+		      RooAbsReal& _x,
+		      RooAbsReal& _mean,
+		      RooAbsReal& _sigma,
+		      const TH1D& hist);
+
+  RooGaussSmearedHist(const RooGaussSmearedHist& other, const char* name=0);
+  inline virtual TObject* clone(const char* newname) const { return new RooGaussSmearedHist(*this,newname); }
+  inline ~RooGaussSmearedHist() {}
+
+  Int_t    getAnalyticalIntegral(RooArgSet& allVars, RooArgSet& analVars, const char* rangeName=0) const;
+  Double_t analyticalIntegral(Int_t code, const char* rangeName=0) const;
+
+  ClassDef(RooGaussSmearedHist,1);
+
+protected:
+  Double_t evaluate() const;
+  Double_t width() const;
+  Int_t    firstBin(const Double_t t) const;
+
+  RooRealProxy x;
+  RooRealProxy mean;
+  RooRealProxy sigma;
+
+  std::vector<Double_t> edges;    // template bin edges
+  std::vector<Double_t> density;  // template content / bin width
+};
+
+#endif
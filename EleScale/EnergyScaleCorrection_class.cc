@@ -47,6 +47,7 @@ EnergyScaleCorrection_class::EnergyScaleCorrection_class(std::string correctionF
     }
   }
   
+  index_.build(scales, smearings);
   return;
 }
 
@@ -93,61 +94,24 @@ float EnergyScaleCorrection_class::getScaleSystUncertainty(unsigned int runNumbe
 
 correctionValue_class EnergyScaleCorrection_class::getScaleCorrection(unsigned int runNumber, bool isEBEle, double R9Ele, double etaSCEle, double EtEle) const
 {
-  // buld the category based on the values of the object
-  correctionCategory_class category(runNumber, etaSCEle, R9Ele, EtEle);
-  correction_map_t::const_iterator corr_itr = scales.find(category); // find the correction value in the map that associates the category to the correction
-  
-  if(corr_itr == scales.end()) { // if not in the standard classes, add it in the list of not defined classes
-    
-    // this part is commented because it makes the method not constant
-    // if(scales_not_defined.count(category) == 0) {
-    // 	correctionValue_class corr;
-    // 	scales_not_defined[category] = corr;
-    // }
-    // corr_itr = scales_not_defined.find(category);
+  const correctionValue_class *corr = getCorrection(runNumber, R9Ele, etaSCEle, EtEle, correctionIndex_class::SCALE);
+  if(corr == NULL) { // not in the defined categories: no correction
     /// \todo this can be switched to an exeption 
     std::cout << "[ERROR] Category not found: " << std::endl;
-    std::cout << category << std::endl;
-    //     exit(1);
+    std::cout << correctionCategory_class(runNumber, etaSCEle, R9Ele, EtEle) << std::endl;
+    return correctionValue_class();
   }
   
 #ifdef DEBUG
-  std::cout << "[DEBUG] Checking correction for category: " << category << std::endl;
-  std::cout << "[DEBUG] Correction is: " << corr_itr->second
-	    << std::endl
-	    << "        given for category " <<  corr_itr->first << std::endl;;
+  std::cout << "[DEBUG] Checking correction for category: " << correctionCategory_class(runNumber, etaSCEle, R9Ele, EtEle) << std::endl;
+  std::cout << "[DEBUG] Correction is: " << *corr << std::endl;
 #endif
-  return corr_itr->second;
+  return *corr;
 }
 
 float EnergyScaleCorrection_class::getScaleOffset(unsigned int runNumber, bool isEBEle, double R9Ele, double etaSCEle, double EtEle) const
 {
-  // buld the category based on the values of the object
-  correctionCategory_class category(runNumber, etaSCEle, R9Ele, EtEle);
-  correction_map_t::const_iterator corr_itr = scales.find(category); // find the correction value in the map that associates the category to the correction
-  
-  if(corr_itr == scales.end()) { // if not in the standard classes, add it in the list of not defined classes
-    
-    // this part is commented because it makes the method not constant
-    // if(scales_not_defined.count(category) == 0) {
-    // 	correctionValue_class corr;
-    // 	scales_not_defined[category] = corr;
-    // }
-    // corr_itr = scales_not_defined.find(category);
-    /// \todo this can be switched to an exeption 
-    std::cout << "[ERROR] Category not found: " << std::endl;
-    std::cout << category << std::endl;
-    //     exit(1);
-  }
-  
-#ifdef DEBUG
-  std::cout << "[DEBUG] Checking correction for category: " << category << std::endl;
-  std::cout << "[DEBUG] Correction is: " << corr_itr->second
-	    << std::endl
-	    << "        given for category " <<  corr_itr->first << std::endl;;
-#endif
-  
-  return corr_itr->second.scale;
+  return getScaleCorrection(runNumber, isEBEle, R9Ele, etaSCEle, EtEle).scale;
 }
 
 
@@ -401,54 +365,108 @@ void EnergyScaleCorrection_class::ReadSmearingFromFile(TString filename)
 float EnergyScaleCorrection_class::getSmearingSigma(int runNumber, float energy, bool isEBEle, float R9Ele, float etaSCEle) const
 {
   
-  correctionCategory_class category(runNumber, etaSCEle, R9Ele, energy / cosh(etaSCEle));
-  correction_map_t::const_iterator corr_itr = smearings.find(category);
-  if(corr_itr == smearings.end()) { // if not in the standard classes, add it in the list of not defined classes
-    // the following commented part makes the method non const
-    // if(smearings_not_defined.count(category) == 0) {
-    // 	correctionValue_class corr;
-    // 	smearings_not_defined[category] = corr;
-    // }
-    corr_itr = smearings_not_defined.find(category);
+  const float EtEle = energy / cosh(etaSCEle);
+  const correctionValue_class *corr = getCorrection(runNumber, R9Ele, etaSCEle, EtEle, correctionIndex_class::SMEARING);
+  if(corr == NULL) { // not in the defined categories: no smearing
     std::cerr << "[WARNING] Category not found: " << std::endl;
-    std::cerr << category << std::endl;
-    //     exit(1);
+    std::cerr << correctionCategory_class(runNumber, etaSCEle, R9Ele, EtEle) << std::endl;
+    return 0;
   }
   
 #ifdef DEBUG
-  std::cout << "[DEBUG] Checking correction for category: " << category << std::endl;
-  std::cout << "[DEBUG] Correction is: " << corr_itr->second
-	    << std::endl
-	    << "        given for category " <<  corr_itr->first;
+  std::cout << "[DEBUG] Checking correction for category: " << correctionCategory_class(runNumber, etaSCEle, R9Ele, EtEle) << std::endl;
+  std::cout << "[DEBUG] Correction is: " << *corr << std::endl;
 #endif
   
-  double constTerm = corr_itr->second.constTerm;
-  double alpha = corr_itr->second.alpha;
-  return sqrt(constTerm * constTerm + alpha * alpha / (energy / cosh(etaSCEle)));
+  double constTerm = corr->constTerm;
+  double alpha = corr->alpha;
+  return sqrt(constTerm * constTerm + alpha * alpha / EtEle);
   
 }
 
 float EnergyScaleCorrection_class::getSmearingRho(int runNumber, float energy, bool isEBEle, float R9Ele, float etaSCEle) const
 {
   
-  correctionCategory_class category(runNumber, etaSCEle, R9Ele, energy / cosh(etaSCEle));
-  correction_map_t::const_iterator corr_itr = smearings.find(category);
-  if(corr_itr == smearings.end()) { // if not in the standard classes, add it in the list of not defined classes
-    // if(smearings_not_defined.count(category) == 0) {
-    // 	correctionValue_class corr;
-    // 	smearings_not_defined[category] = corr;
-    // }
-    corr_itr = smearings_not_defined.find(category);
-  }
+  const correctionValue_class *corr = getCorrection(runNumber, R9Ele, etaSCEle, energy / cosh(etaSCEle), correctionIndex_class::SMEARING);
+  if(corr == NULL) return 0; // not in the defined categories: no smearing
   
-  double constTerm = corr_itr->second.constTerm;
-  double alpha = (corr_itr->second.Emean == 0) ? 0 : corr_itr->second.alpha / corr_itr->second.Emean;
+  double constTerm = corr->constTerm;
+  double alpha = (corr->Emean == 0) ? 0 : corr->alpha / corr->Emean;
   
-  //std::cout << (*corr_itr).second << std::endl;
   return sqrt(constTerm * constTerm + alpha * alpha); ///< return rho; alpha is already scaled by Emean!
   
 }
 
+//============================== interval index
+void correctionIndex_class::build(const correction_map_t& scales, const correction_map_t& smearings)
+{
+  // bin edges: all category boundaries (run ranges are inclusive, so a range ends at runmax+1)
+  for(int iaxis = 0; iaxis < NAXES; iaxis++) edges_[iaxis].clear();
+  const correction_map_t* maps[2] = { &scales, &smearings };
+  for(int imap = 0; imap < 2; imap++) {
+    for(correction_map_t::const_iterator itr = maps[imap]->begin(); itr != maps[imap]->end(); itr++) {
+      const correctionCategory_class& c = itr->first;
+      edges_[RUN].push_back(c.runmin); edges_[RUN].push_back(c.runmax + 1.);
+      edges_[ETA].push_back(c.etamin); edges_[ETA].push_back(c.etamax);
+      edges_[R9].push_back(c.r9min);   edges_[R9].push_back(c.r9max);
+      edges_[ET].push_back(c.etmin);   edges_[ET].push_back(c.etmax);
+    }
+  }
+  size_t ncells = 1;
+  for(int iaxis = 0; iaxis < NAXES; iaxis++) {
+    std::vector<double>& e = edges_[iaxis];
+    std::sort(e.begin(), e.end());
+    e.erase(std::unique(e.begin(), e.end()), e.end());
+    ncells *= (e.size() > 1) ? e.size() - 1 : 0;
+  }
+  cells_.assign(ncells, correctionValue_class());
+  defined_.assign(ncells, 0);
+
+  // every cell takes the values of the scale and the smearing category containing its centre
+  std::vector<size_t> nbins(NAXES), ibin(NAXES, 0);
+  for(int iaxis = 0; iaxis < NAXES; iaxis++) nbins[iaxis] = edges_[iaxis].size() - 1;
+  for(size_t icell = 0; icell < ncells; icell++) {
+    size_t rest = icell;
+    double x[NAXES];
+    for(int iaxis = NAXES - 1; iaxis >= 0; iaxis--) {
+      ibin[iaxis] = rest % nbins[iaxis];
+      rest /= nbins[iaxis];
+      x[iaxis] = 0.5 * (edges_[iaxis][ibin[iaxis]] + edges_[iaxis][ibin[iaxis] + 1]);
+    }
+    int found = 0;
+    for(int imap = 0; imap < 2; imap++) {
+      for(correction_map_t::const_iterator itr = maps[imap]->begin(); itr != maps[imap]->end(); itr++) {
+        const correctionCategory_class& c = itr->first;
+        if(x[RUN] < c.runmin || x[RUN] >= c.runmax + 1.) continue;
+        if(x[ETA] < c.etamin || x[ETA] >= c.etamax) continue;
+        if(x[R9]  < c.r9min  || x[R9]  >= c.r9max)  continue;
+        if(x[ET]  < c.etmin  || x[ET]  >= c.etmax)  continue;
+        correctionValue_class& cell = cells_[icell];
+        if(imap == 0) {
+          cell.scale          = itr->second.scale;
+          cell.scale_err      = itr->second.scale_err;
+          cell.scale_err_syst = itr->second.scale_err_syst;
+        } else {
+          cell.constTerm     = itr->second.constTerm;
+          cell.constTerm_err = itr->second.constTerm_err;
+          cell.alpha         = itr->second.alpha;
+          cell.alpha_err     = itr->second.alpha_err;
+          cell.Emean         = itr->second.Emean;
+          cell.Emean_err     = itr->second.Emean_err;
+        }
+        found |= (imap == 0) ? SCALE : SMEARING;
+        break;
+      }
+    }
+    defined_[icell] = found;
+  }
+  
+#ifdef PEDANTIC_OUTPUT
+  std::cout << "[INFO] correction index: " << ncells << " cells" << std::endl;
+#endif
+  return;
+}
+
 bool correctionCategory_class::operator<(const correctionCategory_class& b) const
 {
   if(runmin < b.runmin && runmax < b.runmax) return true;
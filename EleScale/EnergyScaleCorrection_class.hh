@@ -21,6 +21,8 @@
 #include <iostream>
 #include <fstream>
 #include <map>
+#include <vector>
+#include <algorithm>
 #include <math.h>
 #include <TChain.h>
 #include <TRandom3.h>
@@ -108,6 +110,8 @@ public:
   
   /// for ordering of the categories
   bool operator<(const correctionCategory_class& b) const;
+
+  friend class correctionIndex_class;
   
   /// for DEBUG
   friend std::ostream& operator << (std::ostream& os, const correctionCategory_class a)
@@ -126,6 +130,42 @@ public:
 typedef std::map < correctionCategory_class, correctionValue_class > correction_map_t;
 
 
+//============================== Interval index
+/** Dense grid over run x |eta| x R9 x Et, with the boundaries of all scale and smearing categories
+    as bin edges (run ranges [runmin, runmax+1), the other variables [min, max)).
+    Each cell holds the scale of the scale category and the smearing of the smearing category that
+    contain it, so the corrections of one electron are one cell lookup (a binary search on each axis)
+    instead of a map::find with the overlap ordering of correctionCategory_class.
+ */
+class correctionIndex_class
+{
+public:
+  enum { RUN=0, ETA, R9, ET, NAXES };
+  enum { SCALE=1, SMEARING=2 };  ///< which corrections a cell has
+
+  void build(const correction_map_t& scales, const correction_map_t& smearings);
+
+  /// fused scale and smearing values of the cell, NULL if the point is not covered by a category of each type in mask
+  inline const correctionValue_class* find(const unsigned int runNumber, const float absEta, const float R9Ele, const float EtEle, const int mask) const
+  {
+    const double x[NAXES] = { (double)runNumber, absEta, R9Ele, EtEle };
+    size_t icell = 0;
+    for(int iaxis = 0; iaxis < NAXES; iaxis++) {
+      const std::vector<double>& e = edges_[iaxis];
+      const size_t i = std::upper_bound(e.begin(), e.end(), x[iaxis]) - e.begin();
+      if(i == 0 || i >= e.size()) return NULL;
+      icell = icell * (e.size() - 1) + (i - 1);
+    }
+    return ((defined_[icell] & mask) == mask) ? &cells_[icell] : NULL;
+  }
+
+private:
+  std::vector<double> edges_[NAXES];          ///< bin edges per axis
+  std::vector<correctionValue_class> cells_;  ///< corrections per cell, run-major
+  std::vector<char> defined_;                 ///< SCALE | SMEARING if the cell is covered by a category of that type
+};
+
+
 
 //============================== Main class
 class EnergyScaleCorrection_class
@@ -154,6 +194,14 @@ public:
 	float ScaleCorrectionUncertainty(unsigned int runNumber, bool isEBEle,
 									 double R9Ele, double etaSCEle, double EtEle) const; ///< method to get scale correction uncertainties: it's stat+syst in eta x R9 categories
 
+	/// scale and smearing values of one electron from a single index lookup (Et = E/cosh(eta));
+	/// NULL if it is not in a scale and a smearing category (or only the corrections in mask)
+	inline const correctionValue_class* getCorrection(unsigned int runNumber, double R9Ele, double etaSCEle, double EtEle,
+	                                                  int mask=correctionIndex_class::SCALE | correctionIndex_class::SMEARING) const
+	{
+		return index_.find(runNumber, fabs(etaSCEle), R9Ele, EtEle, mask);
+	}
+
 private:
 	correctionValue_class getScaleCorrection(unsigned int runNumber, bool isEBEle, double R9Ele, double etaSCEle, double EtEle) const; ///< returns the correction value class
 	float getScaleOffset(unsigned int runNumber, bool isEBEle, double R9Ele, double etaSCEle, double EtEle) const; // returns the correction value
@@ -176,6 +224,7 @@ private:
 
 	correction_map_t scales, scales_not_defined;
 	correction_map_t smearings, smearings_not_defined;
+	correctionIndex_class index_;  ///< interval index over scales and smearings, built after reading the files
 
 	void AddSmearing(TString category_, int runMin_, int runMax_, //double smearing_, double err_smearing_);
 	                 double constTerm, double err_constTerm, double alpha, double err_alpha, double Emean, double err_Emean);
@@ -0,0 +1,31 @@
+#!/bin/bash
+
+# Run a selection macro in NPARTS parallel jobs, each processing a contiguous entry range of every
+# sample, then merge the partial ntuples in entry order and normalize the MC weights.
+#
+# usage: ./runSelectionParallel.sh MACRO CONF OUTDIR NPARTS [ARGS]
+#   ARGS: remaining macro arguments before nParts, e.g. "0,1" (doScaleCorr,doSinglePass) for selectZmm
+#
+#   ./runSelectionParallel.sh selectZmm zmm_eos.conf ${NTUPDIR}/Zmumu 32 0,1
+
+MACRO=$1
+CONF=$2
+OUTDIR=$3
+NPARTS=$4
+ARGS=$5
+[ "X$ARGS" != "X" ] && ARGS="${ARGS},"
+
+mkdir -p ${OUTDIR}/logs
+
+# compile once so that the jobs do not race on the shared library
+echo ".L ${MACRO}.C+" | root -l -b
+
+for ((IPART=0; IPART<NPARTS; IPART++)); do
+  root -l -b -q ${MACRO}.C+\(\"${CONF}\",\"${OUTDIR}\",${ARGS}${NPARTS},${IPART}\) >& ${OUTDIR}/logs/${MACRO}_part${IPART}.log &
+done
+wait
+
+echo ".L mergeSelection.C+" | root -l -b
+for PART0 in ${OUTDIR}/ntuples/*.part0.root; do
+  root -l -b -q mergeSelection.C+\(\"${PART0%.part0.root}.root\",${NPARTS}\)
+done
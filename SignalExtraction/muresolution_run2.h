@@ -29,6 +29,16 @@ struct CrystalBall{
     double cdfMa;
     double cdfPa;
   
+    // inverse cdf of the core |x-m| <= min(DTAB,a)*s tabulated on a uniform grid in u (cubic Hermite with
+    // the exact slopes dx/du = 1/pdf): same draws as invcdf to ~1e-5 sigma without TMath::ErfInverse
+    static const int NTAB = 512;
+    static constexpr double DTAB = 2.5;
+    double uTab0;
+    double uTab1;
+    double duTab;
+    double xTab[NTAB+1];
+    double dxTab[NTAB+1];
+  
   CrystalBall():m(0),s(1),a(10),n(10){}
     CrystalBall(double m_, double s_, double a_, double n_){
     init(m_, s_, a_, n_);
@@ -61,6 +71,17 @@ struct CrystalBall{
     
     cdfMa=cdf(m-a*s);
     cdfPa=cdf(m+a*s);
+    
+    double dtab = DTAB;
+    if(fa<dtab) dtab=fa;
+    uTab0 = cdf(m-dtab*s);
+    uTab1 = cdf(m+dtab*s);
+    duTab = (uTab1-uTab0)/NTAB;
+    for(int i=0; i<=NTAB; ++i){
+      double u = (i<NTAB) ? uTab0+i*duTab : uTab1;
+      xTab[i]  = invcdf(u);
+      dxTab[i] = duTab/pdf(xTab[i]);
+    }
   }
   
   double pdf(double x){ 
@@ -82,6 +103,17 @@ struct CrystalBall{
     if(u>cdfPa) return m - G*(F - pow(C-u/NC, -k) );
     return m - S2*s*TMath::ErfInverse((D - u/Ns ) / SPiO2);
   }
+  
+  double invcdfTab(double u){
+    if(u<uTab0 || u>=uTab1) return invcdf(u);
+    double t  = (u-uTab0)/duTab;
+    int    i  = (int)t;
+    if(i>=NTAB) i=NTAB-1;
+    double f  = t-i;
+    double f2 = f*f;
+    double f3 = f2*f;
+    return (2*f3-3*f2+1)*xTab[i] + (f3-2*f2+f)*dxTab[i] + (3*f2-2*f3)*xTab[i+1] + (f3-f2)*dxTab[i+1];
+  }
 };
 
 
@@ -124,11 +156,11 @@ class muresolution {
 	int     D = getBin(v, NTRK, dtrk[H]);
 	double RD = kDat[H]*Sigma(pt, H, D);
 	double RM = kRes[H]*Sigma(pt, H, F);
-	if(RD>RM) x = sqrt(RD*RD-RM*RM)*cb[H][F].invcdf(u);
+	if(RD>RM) x = sqrt(RD*RD-RM*RM)*cb[H][F].invcdfTab(u);
 	else      x = 0;
       }
-      else if(type==Data) x = kDat[H]*Sigma(pt, H, F)*cb[H][F].invcdf(u); 
-      else		  x = kRes[H]*Sigma(pt, H, F)*cb[H][F].invcdf(u);
+      else if(type==Data) x = kDat[H]*Sigma(pt, H, F)*cb[H][F].invcdfTab(u); 
+      else		  x = kRes[H]*Sigma(pt, H, F)*cb[H][F].invcdfTab(u);
     }
     
     return 1.0/(1.0 + x);
@@ -140,8 +172,8 @@ class muresolution {
     double  v = random.Uniform(mtrk[H][F], mtrk[H][F+1]);
     int     D = getBin(v, NTRK, dtrk[H]);
     double  u = random.Rndm();
-    double xd = kDat[H] * Sigma(gpt, H, D) * cb[H][D].invcdf(u);
-    double xm = kRes[H] * Sigma(gpt, H, F) * cb[H][F].invcdf(u);
+    double xd = kDat[H] * Sigma(gpt, H, D) * cb[H][D].invcdfTab(u);
+    double xm = kRes[H] * Sigma(gpt, H, F) * cb[H][F].invcdfTab(u);
     double kold = gpt / rpt;
     double knew = 1.0 + (kold-1.0)*xd/xm; 
     if(knew<0) return kSmear(rpt, eta, nlayers, Extra);
@@ -237,6 +237,7 @@ rochcor2015::rochcor2015(){
       }
   }
 
+  init();
 }
 
 rochcor2015::rochcor2015(int seed){
@@ -254,20 +255,72 @@ rochcor2015::rochcor2015(int seed){
           mptsys_da_da[i][j]=sran.Gaus(0.0, 1.0);
       }
   }
+
+  init();
+}
+
+//-----------------------------------------------------------------------------------------------
+// everything that does not depend on the muon: the (phi,eta) grids of the correction factors
+// and the eta bin lookup tables
+void rochcor2015::init(){
+
+  for(int i=0; i<16; ++i){
+      for(int j=0; j<24; ++j){
+          mc_Mf[i][j] = (mcor_bf[i][j] + mptsys_mc_dm[i][j]*mcor_bfer[i][j])/(mpavg[i][j]+mmavg[i][j]);
+          mc_Af[i][j] = ((mcor_ma[i][j]+mptsys_mc_da[i][j]*mcor_maer[i][j]) - mc_Mf[i][j]*(mpavg[i][j]-mmavg[i][j]));
+          da_Mf[i][j] = (dcor_bf[i][j]+mptsys_da_dm[i][j]*dcor_bfer[i][j])/(dpavg[i][j]+dmavg[i][j]);
+          da_Af[i][j] = ((dcor_ma[i][j]+mptsys_da_da[i][j]*dcor_maer[i][j]) - da_Mf[i][j]*(dpavg[i][j]-dmavg[i][j]));
+      }
+  }
+
+  for(int j=0; j<24; ++j){
+      mc_gscl[j] = ((genm_smr/mrecm) + gscler_mc_dev*mgscl_stat)*mscl[j];
+      da_gscl[j] = ((genm_smr/drecm) + gscler_da_dev*dgscl_stat)*dscl[j];
+  }
+
+  for(int k=0, i=0; k<96; ++k){
+      double x = netabin[0] + 0.05*(k+0.5);
+      while(netabin[i+1] <= x) ++i;
+      etalut[k] = i;
+  }
+  for(int k=0, i=0; k<48; ++k){
+      double x = anetabin[0] + 0.05*(k+0.5);
+      while(anetabin[i+1] <= x) ++i;
+      aetalut[k] = i;
+  }
 }
 
 void rochcor2015::momcor_mc( TLorentzVector& mu, float charge, int ntrk, float& qter){
   
-  //sysdev == num : deviation = num
-  double mupt_bfcor = mu.Pt();
-  double mupt = mu.Pt();
   double muphi = mu.Phi();
   double mueta = mu.Eta(); // same with mu.Eta() in Root
+  double mupt = ptcor_mc(mu.Pt(), mueta, muphi, charge, ntrk, qter);
+  
+  mu.SetPtEtaPhiM(mupt,mueta,muphi,mu_mass);
+}
 
-  double px = mu.Px();
-  double py = mu.Py();
-  double pz = mu.Pz();
-  double e = mu.E();
+
+void rochcor2015::momcor_data( TLorentzVector& mu, float charge, int runopt, float& qter){
+  
+  double muphi = mu.Phi();
+  double mueta = mu.Eta(); // same with mu.Eta() in Root
+  double mupt = ptcor_data(mu.Pt(), mueta, muphi, charge, runopt, qter);
+  
+  mu.SetPtEtaPhiM(mupt,mueta,muphi,mu_mass);
+  
+}
+
+void rochcor2015::momcor_mc(int n, double *pt, const double *eta, const double *phi, const float *charge, const int *ntrk, float *qter){
+  for(int i=0; i<n; ++i) pt[i] = ptcor_mc(pt[i], eta[i], phi[i], charge[i], ntrk[i], qter[i]);
+}
+
+void rochcor2015::momcor_data(int n, double *pt, const double *eta, const double *phi, const float *charge, int runopt, float *qter){
+  for(int i=0; i<n; ++i) pt[i] = ptcor_data(pt[i], eta[i], phi[i], charge[i], runopt, qter[i]);
+}
+
+double rochcor2015::ptcor_mc(double mupt, double mueta, double muphi, float charge, int ntrk, float& qter){
+  
+  double mupt_bfcor = mupt;
 
   int mu_phibin = phibin(muphi);
   int mu_etabin = etabin(mueta);
@@ -275,100 +328,74 @@ void rochcor2015::momcor_mc( TLorentzVector& mu, float charge, int ntrk, float&
   
   if(mu_phibin>=0 && mu_etabin>=0){
     
-    double Mf = (mcor_bf[mu_phibin][mu_etabin] + mptsys_mc_dm[mu_phibin][mu_etabin]*mcor_bfer[mu_phibin][mu_etabin])/(mpavg[mu_phibin][mu_etabin]+mmavg[mu_phibin][mu_etabin]);
-    double Af = ((mcor_ma[mu_phibin][mu_etabin]+mptsys_mc_da[mu_phibin][mu_etabin]*mcor_maer[mu_phibin][mu_etabin]) - Mf*(mpavg[mu_phibin][mu_etabin]-mmavg[mu_phibin][mu_etabin]));     
-    
-    double cor = 1.0/(1.0 + 2.0*Mf + charge*Af*mupt);
+    double cor = 1.0/(1.0 + 2.0*mc_Mf[mu_phibin][mu_etabin] + charge*mc_Af[mu_phibin][mu_etabin]*mupt);
     
     //for the momentum tuning - eta,phi,Q correction
     mupt *= cor;
     
-    double gscl = (genm_smr/mrecm);
-    double gscler = mgscl_stat;    
     double tune = muresol1.kSmear(mupt,mueta,ntrk,muresolution::Extra);
 
-    mupt *= (gscl + gscler_mc_dev*gscler)*(tune*mscl[mu_etabin]);    
+    mupt *= mc_gscl[mu_etabin]*tune;
 
     double pt_tune = (mupt-md[mu_aetabin])*45.0/(45.0-md[mu_aetabin]);
     mupt = pt_tune;
-
     double momscl = mupt_bfcor/mupt;
     qter *= sqrt(momscl*momscl + (1.0-tune)*(1.0-tune));
     
   }
   
-  mu.SetPtEtaPhiM(mupt,mueta,muphi,mu_mass);
+  return mupt;
 }
 
-
-void rochcor2015::momcor_data( TLorentzVector& mu, float charge, int runopt, float& qter){
+double rochcor2015::ptcor_data(double mupt, double mueta, double muphi, float charge, int runopt, float& qter){
   
-  double mupt_bfcor = mu.Pt();
-  double mupt = mu.Pt();
-  
-  double muphi = mu.Phi();
-  double mueta = mu.Eta(); // same with mu.Eta() in Root
-  
-  double px = mu.Px();
-  double py = mu.Py();
-  double pz = mu.Pz();
-  double e = mu.E();
+  double mupt_bfcor = mupt;
   
   int mu_phibin = phibin(muphi);
   int mu_etabin = etabin(mueta);
   int mu_aetabin = aetabin(mueta);
-
   if(mu_phibin>=0 && mu_etabin>=0){
     
-    double Mf = (dcor_bf[mu_phibin][mu_etabin]+mptsys_da_dm[mu_phibin][mu_etabin]*dcor_bfer[mu_phibin][mu_etabin])/(dpavg[mu_phibin][mu_etabin]+dmavg[mu_phibin][mu_etabin]);
-    double Af = ((dcor_ma[mu_phibin][mu_etabin]+mptsys_da_da[mu_phibin][mu_etabin]*dcor_maer[mu_phibin][mu_etabin]) - Mf*(dpavg[mu_phibin][mu_etabin]-dmavg[mu_phibin][mu_etabin]));     
-    
-    double cor = 1.0/(1.0 + 2.0*Mf + charge*Af*mupt);
+    double cor = 1.0/(1.0 + 2.0*da_Mf[mu_phibin][mu_etabin] + charge*da_Af[mu_phibin][mu_etabin]*mupt);
     
     mupt *= cor;  
     
     //after Z pt correction
-    double gscl = (genm_smr/drecm);
-    double gscler = dgscl_stat;
+    mupt *= da_gscl[mu_etabin];
 
-    mupt *= (gscl + gscler_da_dev*gscler)*dscl[mu_etabin];
-    
     double pt_tune = (mupt-dd[mu_aetabin])*45.0/(45.0-dd[mu_aetabin]);
-    mupt = pt_tune; 
-
+    mupt = pt_tune;
     double momscl = mupt_bfcor/mupt;
     qter *= momscl;
     
   }
   
-  mu.SetPtEtaPhiM(mupt,mueta,muphi,mu_mass);
-  
+  return mupt;
 }
 
+// the bins are found in O(1): a first guess from the position and at most one step to correct
+// for rounding at the bin edges
 Int_t rochcor2015::phibin(double phi){
   
-  int nphibin = -1;
+  if(!(-pi <= phi && -pi+(2.0*pi/16.0)*16 > phi)) return -1;
   
-  for(int i=0; i<16; i++){
-    if(-pi+(2.0*pi/16.0)*i <= phi && -pi+(2.0*pi/16.0)*(i+1) > phi){
-      nphibin = i;
-      break;
-    }
-  }
+  int nphibin = (int)((phi+pi)/(2.0*pi/16.0));
+  if(nphibin>15) nphibin = 15;
+  if(-pi+(2.0*pi/16.0)*nphibin > phi) nphibin--;
+  else if(-pi+(2.0*pi/16.0)*(nphibin+1) <= phi) nphibin++;
   
   return nphibin;
 }
 
 Int_t rochcor2015::etabin(double eta){
   
-  int nbin = -1;
+  if(!(netabin[0] <= eta && netabin[24] > eta)) return -1;
   
-  for(int i=0; i<24; i++){
-    if(netabin[i] <= eta && netabin[i+1] > eta){
-      nbin = i;
-      break;
-    }
-  }
+  int k = (int)((eta-netabin[0])*20.0);
+  if(k>95) k = 95;
+  int nbin = etalut[k];
+  if(netabin[nbin] > eta) nbin--;
+  else if(netabin[nbin+1] <= eta) nbin++;
   
   return nbin;
 }
@@ -377,15 +404,14 @@ Int_t rochcor2015::etabin(double eta){
 
 Int_t rochcor2015::aetabin(double eta){
   
-  int nbin = -1;
+  double aeta = fabs(eta);
+  if(!(anetabin[0] <= aeta && anetabin[12] > aeta)) return -1;
   
-  for(int i=0; i<12; i++){
-    if(anetabin[i] <= fabs(eta) && anetabin[i+1] > fabs(eta)){
-      nbin = i;
-      break;
-    }
-  }
+  int k = (int)((aeta-anetabin[0])*20.0);
+  if(k>47) k = 47;
+  int nbin = aetalut[k];
+  if(anetabin[nbin] > aeta) nbin--;
+  else if(anetabin[nbin+1] <= aeta) nbin++;
   
   return nbin;
 }
-
@@ -23,6 +23,14 @@ class rochcor2015 {
   
   void momcor_mc(TLorentzVector&, float, int, float&);
   void momcor_data(TLorentzVector&, float, int, float&);
+
+  // batch versions: the pt of n muons are corrected in place
+  void momcor_mc(int n, double *pt, const double *eta, const double *phi, const float *charge, const int *ntrk, float *qter);
+  void momcor_data(int n, double *pt, const double *eta, const double *phi, const float *charge, int runopt, float *qter);
+  
+  // corrected pt of one muon
+  double ptcor_mc(double pt, double eta, double phi, float charge, int ntrk, float& qter);
+  double ptcor_data(double pt, double eta, double phi, float charge, int runopt, float& qter);
   
   int aetabin(double);
   int etabin(double);
@@ -87,6 +95,22 @@ class rochcor2015 {
   double gscler_mc_dev;
   double gscler_da_dev;
 
+  //===============================================================================================
+  
+  void init();
+  
+  // corrections per (phi,eta) bin for the deviations above, filled by init()
+  double mc_Mf[16][24];
+  double mc_Af[16][24];
+  double da_Mf[16][24];
+  double da_Af[16][24];
+  double mc_gscl[24];
+  double da_gscl[24];
+  
+  // eta bin of each 0.05 wide cell (all bin edges are multiples of 0.05)
+  int etalut[96];
+  int aetalut[48];
+
 
 };
   
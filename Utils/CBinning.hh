@@ -0,0 +1,113 @@
+#ifndef CBINNING_HH
+#define CBINNING_HH
+
+#include <TMath.h>                  // ROOT math library
+#include <vector>                   // STL vector class
+#include <cassert>                  // assertions
+
+//
+// helper class to find the bin of a value for a fixed set of bin edges
+//
+//  * set up once from the bin edges (e.g. parsed from a .bins file), then find() is called per event
+//  * equidistant edges use a direct index computation, others a branch-free binary search, both
+//    giving the same result as testing every bin edge (edges are checked to be increasing once)
+//  * bins are [lo,hi) by default, (lo,hi] with upperClosed (as in the recoil fits)
+//  * with doAbs the absolute value is binned (|eta| binning), all edges must then be >= 0
+//  * find() returns -1 for values outside the binning
+//
+class CBinning
+{
+public:
+  CBinning():fAbs(kFALSE),fUpperClosed(kFALSE),fUniform(kFALSE),fLo(0),fInvWidth(0){}
+  CBinning(const std::vector<Double_t> &edgesv, const Bool_t doAbs=kFALSE, const Bool_t upperClosed=kFALSE) { init(edgesv,doAbs,upperClosed); }
+  CBinning(const Double_t *edges, const Int_t nbins, const Bool_t doAbs=kFALSE, const Bool_t upperClosed=kFALSE) {
+    init(std::vector<Double_t>(edges,edges+nbins+1),doAbs,upperClosed);
+  }
+  ~CBinning(){}
+
+  void init(const std::vector<Double_t> &edgesv, const Bool_t doAbs=kFALSE, const Bool_t upperClosed=kFALSE) {
+    assert(edgesv.size()>1);
+    fEdgesv      = edgesv;
+    fAbs         = doAbs;
+    fUpperClosed = upperClosed;
+    for(UInt_t i=0; i+1<fEdgesv.size(); i++) assert(fEdgesv[i]<fEdgesv[i+1]);
+    if(fAbs) assert(fEdgesv[0]>=0);
+
+    // equidistant edges?
+    const Double_t width = (fEdgesv.back()-fEdgesv[0])/nbins();
+    fUniform = kTRUE;
+    for(UInt_t i=1; i<fEdgesv.size(); i++) {
+      if(fabs(fEdgesv[i]-(fEdgesv[0]+i*width)) > 1e-9*width) { fUniform = kFALSE; break; }
+    }
+    fLo       = fEdgesv[0];
+    fInvWidth = 1.0/width;
+  }
+
+  Int_t    nbins()                 const { return fEdgesv.size()-1; }
+  Double_t lowEdge(const Int_t i)  const { return fEdgesv[i]; }
+  Double_t highEdge(const Int_t i) const { return fEdgesv[i+1]; }
+  const std::vector<Double_t>& edges() const { return fEdgesv; }
+
+  Int_t find(Double_t x) const {
+    if(fAbs) x = fabs(x);
+    const Double_t *e = &fEdgesv[0];
+    const Int_t     n = fEdgesv.size()-1;
+    if(fUpperClosed) { if(!(x> e[0] && x<=e[n])) return -1; }
+    else             { if(!(x>=e[0] && x< e[n])) return -1; }
+
+    Int_t ibin;
+    if(fUniform) {
+      // direct index, corrected by one bin if rounding put x on the wrong side of an edge
+      ibin = TMath::Min(Int_t((x-fLo)*fInvWidth),n-1);
+      if(below(x,e[ibin]))         ibin--;
+      else if(!below(x,e[ibin+1])) ibin++;
+
+    } else {
+      // lower bound search without data-dependent branches
+      ibin = 0;
+      Int_t len = n+1;
+      while(len>1) {
+        const Int_t half = len/2;
+        ibin = below(x,e[ibin+half]) ? ibin : ibin+half;
+        len -= half;
+      }
+    }
+    return ibin;
+  }
+
+protected:
+  // is x in a bin below the edge?
+  Bool_t below(const Double_t x, const Double_t edge) const { return fUpperClosed ? (x<=edge) : (x<edge); }
+
+  std::vector<Double_t> fEdgesv;       // bin edges
+  Bool_t                fAbs;          // bin absolute value?
+  Bool_t                fUpperClosed;  // bins are (lo,hi] instead of [lo,hi)?
+  Bool_t                fUniform;      // equidistant edges?
+  Double_t              fLo;           // lowest edge
+  Double_t              fInvWidth;     // inverse bin width for equidistant edges
+};
+
+//
+// 2D binning with the flattened index iy*nx + ix used for the (eta,pT) and (eta,phi) bins of the
+// tag-and-probe macros, returns -1 if either value is outside the binning
+//
+class CBinning2D
+{
+public:
+  CBinning2D(){}
+  CBinning2D(const CBinning &xbins, const CBinning &ybins):fX(xbins),fY(ybins){}
+  ~CBinning2D(){}
+
+  Int_t nbins() const { return fX.nbins()*fY.nbins(); }
+  Int_t index(const Int_t ix, const Int_t iy) const { return (ix<0 || iy<0) ? -1 : iy*fX.nbins() + ix; }
+  Int_t find(const Double_t x, const Double_t y) const { return index(fX.find(x),fY.find(y)); }
+
+  const CBinning& xbins() const { return fX; }
+  const CBinning& ybins() const { return fY; }
+
+protected:
+  CBinning fX;  // x binning (fast index)
+  CBinning fY;  // y binning
+};
+
+#endif
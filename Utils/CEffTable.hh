@@ -0,0 +1,85 @@
+#ifndef CEFFTABLE_HH
+#define CEFFTABLE_HH
+
+#include <TH2D.h>                   // 2D histograms
+#include <TAxis.h>                  // histogram axis class
+#include <vector>                   // STL vector class
+#include <cassert>                  // assertions
+
+#include "CBinning.hh"              // fast bin lookup
+
+//
+// flat (eta,pT) efficiency table
+//
+//  * filled once from the hEffEtaPt, hErrlEtaPt and hErrhEtaPt histograms of a tag-and-probe result
+//  * efficiency, low error and high error of a bin are stored next to each other in one contiguous
+//    array, so one lookup gives all three
+//  * values outside the table are -1, as for CEffUser2D
+//
+class CEffTable
+{
+public:
+  enum { kEff=0, kErrl, kErrh, kNVal };
+
+  CEffTable(){}
+  ~CEffTable(){}
+
+  // error tables are optional (stored as 0 if not given)
+  void load(const TH2D *eff, const TH2D *errl=0, const TH2D *errh=0) {
+    assert(eff);
+    fBins = CBinning2D(axisBinning(eff->GetXaxis()), axisBinning(eff->GetYaxis()));
+    const Int_t nx = eff->GetNbinsX();
+    const Int_t ny = eff->GetNbinsY();
+    fTable.assign(kNVal*nx*ny, 0);
+    for(Int_t iy=0; iy<ny; iy++) {
+      for(Int_t ix=0; ix<nx; ix++) {
+        Float_t *val = &fTable[kNVal*fBins.index(ix,iy)];
+        val[kEff]  = eff->GetBinContent(eff->GetBin(ix+1,iy+1));
+        val[kErrl] = errl ? errl->GetBinContent(errl->GetBin(ix+1,iy+1)) : 0;
+        val[kErrh] = errh ? errh->GetBinContent(errh->GetBin(ix+1,iy+1)) : 0;
+      }
+    }
+  }
+
+  Bool_t loaded() const { return !fTable.empty(); }
+
+  // pointer to (eff, errl, errh) of the bin containing (x,y), 0 if outside the table
+  const Float_t* find(const Double_t x, const Double_t y) const {
+    const Int_t ibin = fBins.find(x,y);
+    return (ibin<0) ? 0 : &fTable[kNVal*ibin];
+  }
+
+  Float_t get(const Double_t x, const Double_t y, const Int_t ival) const {
+    const Float_t *val = find(x,y);
+    return val ? val[ival] : -1;
+  }
+
+  // efficiency and errors in one lookup, returns kFALSE if (x,y) is outside the table
+  Bool_t getSF(const Double_t x, const Double_t y, Float_t &eff, Float_t &errl, Float_t &errh) const {
+    const Float_t *val = find(x,y);
+    eff  = val ? val[kEff]  : -1;
+    errl = val ? val[kErrl] : -1;
+    errh = val ? val[kErrh] : -1;
+    return val!=0;
+  }
+
+  // batched lookup for n (x,y) pairs, out holds (eff, errl, errh) per pair (size 3n)
+  void getSF(const UInt_t n, const Double_t *x, const Double_t *y, Float_t *out) const {
+    for(UInt_t i=0; i<n; i++) {
+      const Float_t *val = find(x[i],y[i]);
+      for(Int_t k=0; k<kNVal; k++) out[kNVal*i+k] = val ? val[k] : -1;
+    }
+  }
+
+protected:
+  static CBinning axisBinning(const TAxis *axis) {
+    std::vector<Double_t> edgesv;
+    for(Int_t i=1; i<=axis->GetNbins()+1; i++) edgesv.push_back(axis->GetBinLowEdge(i));
+    return CBinning(edgesv);
+  }
+
+  CBinning2D           fBins;   // (x,y) bin lookup
+  std::vector<Float_t> fTable;  // (eff, errl, errh) per bin, bin index iy*nx + ix
+};
+
+#endif
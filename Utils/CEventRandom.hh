@@ -0,0 +1,62 @@
+#ifndef CEVENTRANDOM_HH
+#define CEVENTRANDOM_HH
+
+#include <TMath.h>                  // ROOT math library
+
+//
+// counter-based random numbers of one event
+//
+//  * every number is a hash of (run, lumi section, event, object index, slot), so it does not depend
+//    on which job processes the event or on how many numbers were drawn before it: outputs are
+//    identical for any entry-range partition of a sample and for any processing order
+//  * the same (index, slot) always gives the same number, so a quantity drawn twice (e.g. the
+//    smeared pT of a lepton used for a cut and for its 4-vector) is the same draw
+//  * no state besides the event key, so one instance per event is free and const use is thread safe
+//
+class CEventRandom
+{
+public:
+  CEventRandom(const UInt_t run=0, const UInt_t lumi=0, const ULong64_t evt=0) { setEvent(run, lumi, evt); }
+
+  void setEvent(const UInt_t run, const UInt_t lumi, const ULong64_t evt) { fKey = key(run, lumi, evt); }
+
+  // 64-bit identifier of an event (run, lumi section, event), e.g. for the evtId of the recoil correctors
+  static ULong64_t key(const UInt_t run, const UInt_t lumi, const ULong64_t evt) { return mix(mix(mix(run) ^ lumi) ^ evt); }
+
+  // uniform in (0,1)
+  Double_t uniform(const UInt_t index, const UInt_t slot=0) const { return toUnit(hash(index, slot)); }
+
+  // normal distribution (Box-Muller)
+  Double_t gaus(const UInt_t index, const UInt_t slot=0, const Double_t mean=0, const Double_t sigma=1) const {
+    const ULong64_t h  = hash(index, slot);
+    const Double_t  u1 = toUnit(h);
+    const Double_t  u2 = toUnit(mix(h));
+    return mean + sigma*TMath::Sqrt(-2.0*TMath::Log(u1))*TMath::Cos(TMath::TwoPi()*u2);
+  }
+
+  // k-th uniform number in (0,1) of the stream (seed, id), for generators keyed by an event
+  // identifier of their own (RecoilCorrector, RecoilCorrectorHist)
+  static Double_t uniform(const ULong64_t seed, const ULong64_t id, const UInt_t k) {
+    return toUnit(mix(mix(seed + 0x9E3779B97F4A7C15ULL*id) + 0x9E3779B97F4A7C15ULL*k));
+  }
+
+  // splitmix64 finalizer
+  static ULong64_t mix(ULong64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x  = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x  = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+  }
+
+protected:
+  ULong64_t hash(const UInt_t index, const UInt_t slot) const {
+    return mix(fKey ^ mix((ULong64_t(index) << 32) | slot));
+  }
+
+  // upper 53 bits at bin centres, never 0 or 1
+  static Double_t toUnit(const ULong64_t h) { return (Double_t(h >> 11) + 0.5) * (1.0/9007199254740992.0); }
+
+  ULong64_t fKey;
+};
+
+#endif
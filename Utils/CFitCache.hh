@@ -0,0 +1,143 @@
+#ifndef CFITCACHE_HH
+#define CFITCACHE_HH
+
+#include <TSystem.h>                // interface to OS
+#include <TString.h>                // ROOT string class
+#include <TH1.h>                    // histogram base class
+#include <TTree.h>                  // class to access ntuples
+#include <TBranch.h>                // class to access ntuple branches
+#include <RooArgSet.h>              // RooFit set of variables
+#include <RooArgList.h>             // RooFit list of variables
+#include <RooRealVar.h>             // RooFit variable
+#include <fstream>                  // functions for file I/O
+#include <string>                   // C++ string class
+#include <vector>                   // STL vector class
+
+//
+// helper class for a content-addressed cache of fit results
+//
+//  * the key is a 64-bit FNV-1a hash of everything the fit depends on (input histograms, model
+//    choices, bin edges, templates), added with add()
+//  * an entry is <key>.par (efficiency, errors and fitted parameters) plus <key>.txt (copy of the
+//    fit result file), stored under dir(); an empty dir() turns caching off
+//  * the first fitted parameters of a bin are kept as seed_<hash of bin name>.par and are the
+//    starting point of all later fits of that bin (instead of the default values); they are never
+//    overwritten and are part of the key, so a result only depends on its own bin and the cache
+//    directory, not on the order or the split of the bins among jobs
+//
+class CFitCache
+{
+public:
+  typedef std::vector<std::pair<std::string,Double_t> > ParList;  // (name, value) of fitted parameters
+
+  CFitCache():fHash(14695981039346656037ULL){}
+  ~CFitCache(){}
+
+  static TString& dir() { static TString sDir; return sDir; }
+  static Bool_t   enabled() { return dir().Length()>0; }
+
+  //
+  // key
+  //
+  void add(const void *buf, const size_t len) {
+    const unsigned char *p = (const unsigned char*)buf;
+    for(size_t i=0; i<len; i++) { fHash ^= p[i]; fHash *= 1099511628211ULL; }
+  }
+  void add(const Int_t    x) { add(&x,sizeof(x)); }
+  void add(const Double_t x) { add(&x,sizeof(x)); }
+  void add(const TString &s) { add(s.Data(),s.Length()+1); }
+
+  // binning, contents and errors (including under/overflow)
+  void add(const TH1 *h) {
+    if(!h) { add(Int_t(-1)); return; }
+    add(Int_t(h->GetNbinsX()));
+    for(Int_t i=1; i<=h->GetNbinsX()+1; i++) add(h->GetXaxis()->GetBinLowEdge(i));
+    for(Int_t i=0; i<=h->GetNbinsX()+1; i++) { add(h->GetBinContent(i)); add(h->GetBinError(i)); }
+  }
+
+  // all values of a Float_t branch
+  void add(TTree *tree, const char *bname) {
+    TBranch *br = tree ? tree->GetBranch(bname) : 0;
+    if(!br) { add(Int_t(-1)); return; }
+    Float_t x;
+    br->SetAddress(&x);
+    for(Long64_t i=0; i<br->GetEntries(); i++) { br->GetEntry(i); add(&x,sizeof(x)); }
+    tree->ResetBranchAddresses();
+  }
+
+  TString key() const { return TString::Format("%016llx",(unsigned long long)fHash); }
+
+  //
+  // cache entries
+  //
+  // seed of bin binname (empty if none), added to the key: call before fetch()
+  Bool_t loadSeed(const TString &binname, ParList &seed) {
+    seed.clear();
+    Double_t eff, errl, errh;
+    const Bool_t found = enabled() && readPars(seedName(binname), eff, errl, errh, &seed);
+    add(Int_t(seed.size()));
+    for(UInt_t i=0; i<seed.size(); i++) { add(TString(seed[i].first.c_str())); add(seed[i].second); }
+    return found;
+  }
+
+  // results of key, copies the stored fit result file to fitresname
+  Bool_t fetch(const TString &fitresname, Double_t &eff, Double_t &errl, Double_t &errh) const {
+    if(!enabled()) return kFALSE;
+    const TString txtname = dir() + "/" + key() + ".txt";
+    if(gSystem->AccessPathName(txtname)) return kFALSE;
+    if(!readPars(dir() + "/" + key() + ".par", eff, errl, errh, 0)) return kFALSE;
+    return gSystem->CopyFile(txtname, fitresname, kTRUE)==0;
+  }
+
+  // store results of key, and the seed of bin binname if it has none yet
+  void store(const TString &fitresname, const TString &binname,
+             const Double_t eff, const Double_t errl, const Double_t errh, const RooArgList &pars) const {
+    if(!enabled()) return;
+    gSystem->mkdir(dir(),kTRUE);
+    writePars(dir() + "/" + key() + ".par", eff, errl, errh, pars);
+    gSystem->CopyFile(fitresname, dir() + "/" + key() + ".txt", kTRUE);
+    const TString seedname = seedName(binname);
+    if(gSystem->AccessPathName(seedname)) writePars(seedname, eff, errl, errh, pars);
+  }
+
+  // set the free parameters in pars to the seed values (if inside their range)
+  static void hotStart(const ParList &seed, RooArgSet &pars) {
+    for(UInt_t i=0; i<seed.size(); i++) {
+      RooRealVar *var = dynamic_cast<RooRealVar*>(pars.find(seed[i].first.c_str()));
+      const Double_t val = seed[i].second;
+      if(var && !var->isConstant() && val>=var->getMin() && val<=var->getMax()) var->setVal(val);
+    }
+  }
+
+protected:
+  static TString seedName(const TString &binname) {
+    CFitCache h;
+    h.add(binname);
+    return dir() + "/seed_" + h.key() + ".par";
+  }
+
+  static void writePars(const TString &fname, const Double_t eff, const Double_t errl, const Double_t errh, const RooArgList &pars) {
+    std::ofstream ofs(fname.Data());
+    ofs.precision(17);
+    ofs << eff << " " << errl << " " << errh << std::endl;
+    for(Int_t i=0; i<pars.getSize(); i++) {
+      const RooRealVar *var = dynamic_cast<const RooRealVar*>(pars.at(i));
+      if(var) ofs << var->GetName() << " " << var->getVal() << std::endl;
+    }
+  }
+
+  static Bool_t readPars(const TString &fname, Double_t &eff, Double_t &errl, Double_t &errh, ParList *pars) {
+    std::ifstream ifs(fname.Data());
+    if(!ifs.is_open()) return kFALSE;
+    if(!(ifs >> eff >> errl >> errh)) return kFALSE;
+    std::string vname;
+    Double_t val;
+    if(pars) pars->clear();
+    while(pars && (ifs >> vname >> val)) pars->push_back(std::make_pair(vname,val));
+    return kTRUE;
+  }
+
+  unsigned long long fHash;  // FNV-1a hash of the inputs
+};
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef CFLATSKIM_HH
+#define CFLATSKIM_HH
+
+#include <TTree.h>                  // class to access ntuples
+#include <TBranch.h>                // class to access ntuple branches
+#include <TLeaf.h>                  // class to access ntuple leaves
+#include <TString.h>                // ROOT string class
+#include "TLorentzVector.h"         // 4-vector class
+#include <vector>                   // STL vector class
+#include <iostream>                 // standard I/O
+#include <cassert>                  // assertions
+
+//
+// 4-vector branches of the selection ntuples ("Events") in either layout
+//
+//  * object layout: one TLorentzVector branch per 4-vector, as written by default
+//  * flat layout: <name>_pt, <name>_eta, <name>_phi, <name>_m Float_t columns, so reading a 4-vector
+//    is four plain column reads instead of streaming an object (values rounded to float precision)
+//  * writer: book() each 4-vector pointer, fill() copies the 4-vectors into the columns before
+//    tree->Fill(); tune() sets per-branch compression and basket sizes of a flat ntuple
+//  * reader: attach() takes either layout (and enables its branches), update() after GetEntry()
+//    rebuilds the 4-vectors of flat columns, so loops keep using lep1->Pt() etc. unchanged; all
+//    readers of the selection ntuples go through attach(), so they take either layout
+//
+class CFlatSkim
+{
+public:
+  enum { kPt=0, kEta, kPhi, kM, kNCol };
+
+  // flat ntuples: float kinematics hardly compress at higher levels, so they get the cheapest zlib
+  // setting; integer columns (run/event numbers, categories, bits) compress well at no read cost;
+  // baskets are sized to hold a large cluster per branch for sequential reads
+  enum { kFloatCompress=101, kIntCompress=106, kBasketSize=256000, kClusterBytes=64*1024*1024 };
+
+  CFlatSkim():fTree(0),fFlat(kFALSE){}
+  ~CFlatSkim() { clear(); }
+
+  //
+  // writer
+  //
+  void initWrite(TTree *tree, const Bool_t flat) {
+    fTree = tree;
+    fFlat = flat;
+  }
+
+  void book(const char *name, TLorentzVector **addr) {
+    assert(fTree);
+    LV *lv = add(name, addr, fFlat);
+    if(!fFlat) {
+      fTree->Branch(name, "TLorentzVector", addr);
+      return;
+    }
+    for(Int_t k=0; k<kNCol; k++) fTree->Branch(colName(name,k), &lv->col[k], colName(name,k)+"/F");
+  }
+
+  void fill() {
+    for(UInt_t i=0; i<fLVv.size(); i++) {
+      LV *lv = fLVv[i];
+      if(!lv->flat) continue;
+      const TLorentzVector *p = *lv->addr;
+      if(!p) {
+        for(Int_t k=0; k<kNCol; k++) lv->col[k] = 0;
+        continue;
+      }
+      const Double_t pt = p->Pt();
+      lv->col[kPt]  = pt;
+      lv->col[kEta] = (pt>0) ? p->Eta() : 0;  // no warning for the null 4-vectors of non-signal MC
+      lv->col[kPhi] = (pt>0) ? p->Phi() : 0;
+      lv->col[kM]   = p->M();
+    }
+  }
+
+  // call after all branches are booked
+  void tune() {
+    assert(fTree);
+    if(!fFlat) return;
+    fTree->SetAutoFlush(-Long64_t(kClusterBytes));
+    TObjArray *branchv = fTree->GetListOfBranches();
+    for(Int_t i=0; i<branchv->GetEntries(); i++) {
+      TBranch *br   = (TBranch*)branchv->At(i);
+      TLeaf   *leaf = (TLeaf*)br->GetListOfLeaves()->At(0);
+      const TString type = leaf ? leaf->GetTypeName() : "";
+      br->SetCompressionSettings((type=="Float_t" || type=="Double_t") ? kFloatCompress : kIntCompress);
+      br->SetBasketSize(kBasketSize);
+    }
+  }
+
+  //
+  // reader
+  //
+  // one reader can be re-initialized for each input file; pointers of the previous file's flat
+  // 4-vectors are reset, so an object branch of the next file gets a fresh object
+  void initRead(TTree *tree) {
+    clear();
+    fTree = tree;
+    fFlat = kFALSE;
+  }
+
+  // attach a 4-vector of either layout; if the tree has neither, abort (or return kFALSE if the
+  // 4-vector is optional)
+  Bool_t attach(const char *name, TLorentzVector **addr, const Bool_t optional=kFALSE) {
+    assert(fTree);
+    const Bool_t flat = (fTree->GetBranch(colName(name,kPt))!=0);
+    if(!flat && !fTree->GetBranch(name)) {
+      if(optional) return kFALSE;
+      std::cout << "No 4-vector branch " << name << " in tree " << fTree->GetName() << "! Aborting..." << std::endl;
+      assert(0);
+    }
+    LV *lv = add(name, addr, flat);
+    if(!flat) {
+      fTree->SetBranchStatus(name, 1);
+      fTree->SetBranchAddress(name, addr);
+      return kTRUE;
+    }
+    fFlat = kTRUE;
+    for(Int_t k=0; k<kNCol; k++) {
+      fTree->SetBranchStatus(colName(name,k), 1);
+      fTree->SetBranchAddress(colName(name,k), &lv->col[k]);
+    }
+    *addr = &lv->p4;
+    return kTRUE;
+  }
+
+  void update() {
+    for(UInt_t i=0; i<fLVv.size(); i++) {
+      LV *lv = fLVv[i];
+      if(lv->flat) lv->p4.SetPtEtaPhiM(lv->col[kPt], lv->col[kEta], lv->col[kPhi], lv->col[kM]);
+    }
+  }
+
+  Bool_t flat() const { return fFlat; }
+
+  static TString colName(const char *name, const Int_t k) {
+    static const char* suffixv[kNCol] = { "_pt", "_eta", "_phi", "_m" };
+    return TString(name) + suffixv[k];
+  }
+
+protected:
+  struct LV {
+    TString          name;
+    TLorentzVector **addr;
+    Bool_t           flat;
+    Float_t          col[kNCol];  // flat columns
+    TLorentzVector   p4;          // 4-vector rebuilt from the columns (reader)
+  };
+
+  // entries are allocated one by one, branch addresses of their columns stay valid
+  LV* add(const char *name, TLorentzVector **addr, const Bool_t flat) {
+    LV *lv = new LV();
+    lv->name = name;
+    lv->addr = addr;
+    lv->flat = flat;
+    for(Int_t k=0; k<kNCol; k++) lv->col[k] = 0;
+    fLVv.push_back(lv);
+    return lv;
+  }
+
+  void clear() {
+    for(UInt_t i=0; i<fLVv.size(); i++) {
+      if(*fLVv[i]->addr==&fLVv[i]->p4) *fLVv[i]->addr = 0;
+      delete fLVv[i];
+    }
+    fLVv.clear();
+  }
+
+  TTree            *fTree;
+  Bool_t            fFlat;   // writer: flat layout; reader: any 4-vector read from flat columns
+  std::vector<LV*>  fLVv;
+};
+
+#endif
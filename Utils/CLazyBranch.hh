@@ -0,0 +1,53 @@
+#ifndef CLAZYBRANCH_HH
+#define CLAZYBRANCH_HH
+
+#include <TTree.h>                  // class to access ntuples
+#include <TBranch.h>                // class to access ntuple branches
+#include <TClonesArray.h>           // ROOT array class
+
+//
+// helper class to read a Bacon branch on demand
+//
+//  * a branch is read (and decompressed) at most once per entry, and only when a cut asks for it,
+//    so cuts can be ordered from cheap (Info) to expensive (GenParticle) without bookkeeping
+//  * branches set up with init() are registered in the tree cache, which then prefetches only the
+//    branches the macro actually uses: call tree->SetCacheSize() before and
+//    tree->StopCacheLearningPhase() after setting up all branches; a branch read only for few
+//    entries (e.g. GenParticle) is better left out of the cache and read directly
+//
+class CLazyBranch
+{
+public:
+  CLazyBranch():fBranch(0),fArr(0),fEntry(-1){}
+  ~CLazyBranch(){}
+
+  // attach branch to an object address (pass the TClonesArray to have it cleared before each read),
+  // prefetched by the tree cache unless cache is kFALSE
+  Bool_t init(TTree *tree, const char *name, void *addr, TClonesArray *arr=0, const Bool_t cache=kTRUE) {
+    fBranch = 0;
+    fArr    = arr;
+    fEntry  = -1;
+    if(!tree->GetBranch(name)) return kFALSE;
+    tree->SetBranchAddress(name, addr);
+    fBranch = tree->GetBranch(name);
+    if(cache) tree->AddBranchToCache(fBranch, kTRUE);
+    return kTRUE;
+  }
+
+  // read the branch for entry ientry, unless already done
+  void get(const Long64_t ientry) {
+    if(!fBranch || ientry==fEntry) return;
+    if(fArr) fArr->Clear();
+    fBranch->GetEntry(ientry);
+    fEntry = ientry;
+  }
+
+  Bool_t valid() const { return fBranch!=0; }
+
+protected:
+  TBranch      *fBranch;  // branch handle
+  TClonesArray *fArr;     // array to clear before reading (if any)
+  Long64_t      fEntry;   // entry currently loaded
+};
+
+#endif
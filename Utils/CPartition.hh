@@ -0,0 +1,74 @@
+#ifndef CPARTITION_HH
+#define CPARTITION_HH
+
+#include <TString.h>                // ROOT string class
+#include <TFile.h>                  // file handle class
+#include <TTree.h>                  // class to access ntuples
+#include <TMath.h>                  // ROOT math library
+#include <vector>                   // STL vector class
+#include <cassert>                  // assertions
+
+//
+// helper class to split the events of a sample into contiguous entry ranges
+//
+//  * the entries of all input files of a sample are concatenated and divided into nparts ranges,
+//    so that merging the outputs of all parts in order reproduces the entry order of a single job
+//  * with nparts=1 no input file is opened and every file is processed in full
+//
+class CPartition
+{
+public:
+  CPartition(const std::vector<TString> &fnamev, const UInt_t nparts, const UInt_t ipart):
+    fNParts(nparts),fIPart(ipart),fFirstv(fnamev.size(),0),fLastv(fnamev.size(),-1)
+  {
+    assert(ipart<nparts);
+    if(nparts<=1) return;
+
+    // count entries per input file (reads only the file headers)
+    std::vector<Long64_t> nentriesv(fnamev.size(),0);
+    Long64_t ntotal=0;
+    for(UInt_t ifile=0; ifile<fnamev.size(); ifile++) {
+      if(fnamev[ifile]=="/dev/null") continue;
+      TFile *infile = TFile::Open(fnamev[ifile]);
+      assert(infile);
+      TTree *eventTree = (TTree*)infile->Get("Events");
+      assert(eventTree);
+      nentriesv[ifile] = eventTree->GetEntries();
+      ntotal += nentriesv[ifile];
+      delete infile;
+    }
+
+    // global entry range of this part, mapped back onto each input file
+    const Long64_t gfirst = ntotal*ipart/nparts;
+    const Long64_t glast  = ntotal*(ipart+1)/nparts;
+    Long64_t offset=0;
+    for(UInt_t ifile=0; ifile<fnamev.size(); ifile++) {
+      fFirstv[ifile] = TMath::Min(TMath::Max(gfirst-offset,Long64_t(0)),nentriesv[ifile]);
+      fLastv[ifile]  = TMath::Min(TMath::Max(glast -offset,Long64_t(0)),nentriesv[ifile]);
+      offset += nentriesv[ifile];
+    }
+  }
+  ~CPartition(){}
+
+  Bool_t   active()                      const { return fNParts>1; }
+  Bool_t   hasEntries(const UInt_t ifile) const { return fNParts<=1 || fLastv[ifile]>fFirstv[ifile]; }
+  Long64_t first(const UInt_t ifile)      const { return fFirstv[ifile]; }
+  Long64_t last(const UInt_t ifile, const Long64_t nentries) const { return (fNParts<=1) ? nentries : fLastv[ifile]; }
+
+  // output file name of this part, e.g. zmm_select.root -> zmm_select.part3.root
+  TString outname(const TString fname) const { return (fNParts<=1) ? fname : partName(fname,fIPart); }
+
+  static TString partName(const TString fname, const UInt_t ipart) {
+    TString name = fname;
+    name.ReplaceAll(".root",TString::Format(".part%u.root",ipart));
+    return name;
+  }
+
+protected:
+  UInt_t                fNParts;   // number of parts per sample
+  UInt_t                fIPart;    // part processed by this job
+  std::vector<Long64_t> fFirstv;   // first entry per input file
+  std::vector<Long64_t> fLastv;    // one past last entry per input file
+};
+
+#endif
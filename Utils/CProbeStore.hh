@@ -0,0 +1,112 @@
+#ifndef CPROBESTORE_HH
+#define CPROBESTORE_HH
+
+#include <TH1D.h>                   // 1D histograms
+#include <TTree.h>                  // class to access ntuples
+#include <TMath.h>                  // ROOT math library
+#include <vector>                   // STL vector class
+#include <cassert>                  // assertions
+
+//
+// pass/fail probe storage for the tag-and-probe bins of one projection
+//
+//  * probes are accumulated directly into dense (bin x pass/fail x mass bin) arrays of sum of
+//    weights and sum of squared weights, with the same bin finding as TH1 (including under/overflow),
+//    so fillHist() gives the histogram a Draw() of the probes would give
+//  * with keepProbes the mass and weight of each probe are kept as well (columns per bin), for
+//    probe counting and unbinned fits; makeTree() builds the m/w tree of a bin on demand
+//
+class CProbeStore
+{
+public:
+  enum { kPass=0, kFail, kNCat };
+
+  CProbeStore(const Int_t nbins, const Double_t massLo, const Double_t massHi, const Int_t nmPass, const Int_t nmFail,
+              const Bool_t keepProbes=kFALSE):
+  fNbins(nbins),fMassLo(massLo),fMassHi(massHi),fKeep(keepProbes)
+  {
+    assert(nbins>0 && massHi>massLo && nmPass>0 && nmFail>0);
+    fNm[kPass]     = nmPass;
+    fNm[kFail]     = nmFail;
+    fOffset[kPass] = 0;
+    fOffset[kFail] = nmPass+2;
+    fStride        = (nmPass+2) + (nmFail+2);
+    fSumw .assign(fNbins*fStride, 0);
+    fSumw2.assign(fNbins*fStride, 0);
+    fEntries.assign(fNbins*kNCat, 0);
+    if(fKeep) {
+      fMassv.resize(fNbins*kNCat);
+      fWgtv .resize(fNbins*kNCat);
+    }
+  }
+  ~CProbeStore(){}
+
+  void fill(const Int_t ibin, const Bool_t pass, const Float_t m, const Double_t w) {
+    const Int_t icat = pass ? kPass : kFail;
+    const Int_t idx  = ibin*fStride + fOffset[icat] + massBin(icat,m);
+    fSumw[idx]  += w;
+    fSumw2[idx] += w*w;
+    fEntries[ibin*kNCat+icat]++;
+    if(fKeep) {
+      fMassv[ibin*kNCat+icat].push_back(m);
+      fWgtv [ibin*kNCat+icat].push_back(w);
+    }
+  }
+
+  Int_t    nbins()                                       const { return fNbins; }
+  Bool_t   hasProbes()                                   const { return fKeep; }
+  UInt_t   entries(const Int_t ibin, const Bool_t pass)  const { return fEntries[ibin*kNCat + (pass ? kPass : kFail)]; }
+
+  // mass and weight columns of a bin (keepProbes only)
+  const std::vector<Float_t>&  masses(const Int_t ibin, const Bool_t pass)  const { assert(fKeep); return fMassv[ibin*kNCat + (pass ? kPass : kFail)]; }
+  const std::vector<Double_t>& weights(const Int_t ibin, const Bool_t pass) const { assert(fKeep); return fWgtv [ibin*kNCat + (pass ? kPass : kFail)]; }
+
+  // fill histogram with the stored mass distribution (binning must match the store)
+  void fillHist(const Int_t ibin, const Bool_t pass, TH1D *h) const {
+    const Int_t icat = pass ? kPass : kFail;
+    assert(h->GetNbinsX()==fNm[icat] && h->GetXaxis()->GetXmin()==fMassLo && h->GetXaxis()->GetXmax()==fMassHi);
+    const Double_t *sumw  = &fSumw [ibin*fStride + fOffset[icat]];
+    const Double_t *sumw2 = &fSumw2[ibin*fStride + fOffset[icat]];
+    for(Int_t i=0; i<=fNm[icat]+1; i++) {
+      h->SetBinContent(i, sumw[i]);
+      h->SetBinError(i, TMath::Sqrt(sumw2[i]));
+    }
+    h->SetEntries(entries(ibin,pass));
+  }
+
+  // m/w tree of a bin for unbinned fits (keepProbes only), owned by the caller
+  TTree* makeTree(const Int_t ibin, const Bool_t pass, const char *name) const {
+    const std::vector<Float_t>  &mv = masses(ibin,pass);
+    const std::vector<Double_t> &wv = weights(ibin,pass);
+    Float_t  m;
+    Double_t w;
+    TTree *tree = new TTree(name,"");
+    tree->SetDirectory(0);
+    tree->Branch("m",&m,"m/F");
+    tree->Branch("w",&w,"w/D");
+    for(UInt_t i=0; i<mv.size(); i++) { m = mv[i]; w = wv[i]; tree->Fill(); }
+    tree->ResetBranchAddresses();
+    return tree;
+  }
+
+protected:
+  // same bin (0 = underflow, n+1 = overflow) as TAxis::FindBin for fixed bins
+  Int_t massBin(const Int_t icat, const Double_t m) const {
+    if(m <  fMassLo) return 0;
+    if(m >= fMassHi) return fNm[icat]+1;
+    return 1 + Int_t(fNm[icat]*(m-fMassLo)/(fMassHi-fMassLo));
+  }
+
+  Int_t    fNbins;                               // number of kinematic bins
+  Double_t fMassLo, fMassHi;                     // mass range
+  Int_t    fNm[kNCat];                           // number of mass bins, pass and fail
+  Int_t    fOffset[kNCat];                       // offset of the pass and fail mass bins within a kinematic bin
+  Int_t    fStride;                              // array size per kinematic bin
+  Bool_t   fKeep;                                // keep individual probes?
+  std::vector<Double_t> fSumw, fSumw2;           // (bin x pass/fail x mass bin) sums of weights
+  std::vector<UInt_t>   fEntries;                // (bin x pass/fail) number of probes
+  std::vector< std::vector<Float_t> >  fMassv;   // (bin x pass/fail) probe masses
+  std::vector< std::vector<Double_t> > fWgtv;    // (bin x pass/fail) probe weights
+};
+
+#endif
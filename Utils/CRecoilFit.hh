@@ -0,0 +1,217 @@
+#ifndef CRECOILFIT_HH
+#define CRECOILFIT_HH
+
+#include <TH1D.h>                   // 1D histograms
+#include <TCanvas.h>                // class for drawing
+#include <TMath.h>                  // ROOT math library
+#include <TString.h>                // ROOT string class
+#include <vector>                   // STL vector class
+#include <iostream>                 // standard I/O
+#include <cstdio>                   // fflush()
+#include <cassert>                  // assertions
+#include <unistd.h>                 // fork() and pipe() for parallel fits
+#include <sys/wait.h>               // waitpid()
+
+#include "MitStyleRemix.hh"         // style settings for drawing
+
+//
+// engine for the per-pT-bin fits of the recoil components
+//
+//  * a job is one component (u1 or u2) in one boson pT bin; every job is started from a seed
+//    computed from the moments of its own histogram (momentSeed), so all jobs are independent and
+//    run in nWorkers forked processes (RooFit is not thread safe), results coming back through a pipe
+//  * an optional second pass re-fits every bin from the first-pass result of its lower neighbour
+//    (as the old serial fits did) and keeps whichever of the two minima has the lower NLL
+//  * the fit of one job is done by the macro (model ranges, plots), fitFcn(job, canvas)
+//
+struct CRecoilFitPars
+{
+  enum { kMean=0, kSigma0, kSigma1, kSigma2, kSigma3, kFrac2, kFrac3, kNPar };
+  Double_t val[kNPar], err[kNPar];  // fitted values and errors
+  Double_t minNll;                  // NLL at the minimum
+  Int_t    status;                  // fit status (0 = OK, -1 = not fitted)
+};
+
+struct CRecoilFitJob
+{
+  const TH1D *h, *hbkg;             // recoil component and background template of the bin
+  Int_t    icomp, ibin;             // component (0: u1, 1: u2) and pT bin
+  Double_t ptLo, ptHi;              // pT bin edges
+  Int_t    model;                   // 1, 2, 3 Gaussians
+  Bool_t   sigOnly;                 // signal only fit?
+  TString  plabel, xlabel;          // plot name prefix and x-axis label
+  Bool_t   warmStart;               // seed from warmSeed instead of the histogram moments?
+  CRecoilFitPars warmSeed;          // neighbour result for the second pass
+  CRecoilFitPars prev;              // first pass result of the bin (second pass only)
+  CRecoilFitPars res;               // fit result
+};
+
+typedef void (*RecoilFitFcn)(CRecoilFitJob &job, TCanvas *c);
+
+//--------------------------------------------------------------------------------------------------
+// moment-based starting point: mean and the widths of a 50/50 double Gaussian with the variance
+// and fourth moment of the histogram, (s1^2 + s2^2)/2 = V and 3(s1^4 + s2^4)/2 = m4
+inline void momentSeed(const TH1D *h, Double_t &mean, Double_t &sigma1, Double_t &sigma2)
+{
+  Double_t sumw=0, sum1=0;
+  for(Int_t i=1; i<=h->GetNbinsX(); i++) { sumw += h->GetBinContent(i); sum1 += h->GetBinContent(i)*h->GetBinCenter(i); }
+  mean = (sumw>0) ? sum1/sumw : 0;
+  Double_t m2=0, m4=0;
+  for(Int_t i=1; i<=h->GetNbinsX(); i++) {
+    const Double_t d2 = (h->GetBinCenter(i)-mean)*(h->GetBinCenter(i)-mean);
+    m2 += h->GetBinContent(i)*d2;
+    m4 += h->GetBinContent(i)*d2*d2;
+  }
+  if(sumw>0) { m2 /= sumw; m4 /= sumw; }
+  const Double_t d = TMath::Min(TMath::Sqrt(TMath::Max(m4/3. - m2*m2, 0.)), 0.9*m2);
+  sigma1 = TMath::Sqrt(m2-d);
+  sigma2 = TMath::Sqrt(m2+d);
+}
+
+//--------------------------------------------------------------------------------------------------
+// jobs of one component, one per pT bin
+inline void addRecoilFitJobs(std::vector<CRecoilFitJob> &jobv, const std::vector<TH1D*> &hv, const std::vector<TH1D*> &hbkgv,
+                             const Double_t *ptbins, const Int_t nbins, const Int_t model, const Bool_t sigOnly,
+                             const Int_t icomp, const char *plabel, const char *xlabel)
+{
+  for(Int_t ibin=0; ibin<nbins; ibin++) {
+    CRecoilFitJob job;
+    job.h       = hv[ibin];
+    job.hbkg    = hbkgv[ibin];
+    job.icomp   = icomp;
+    job.ibin    = ibin;
+    job.ptLo    = ptbins[ibin];
+    job.ptHi    = ptbins[ibin+1];
+    job.model   = model;
+    job.sigOnly = sigOnly;
+    job.plabel  = plabel;
+    job.xlabel  = xlabel;
+    job.warmStart = kFALSE;
+    job.res.status = -1;
+    jobv.push_back(job);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+// run fitFcn on all jobs, in nWorkers forked processes if nWorkers>1
+inline void runRecoilFitJobs(std::vector<CRecoilFitJob> &jobv, RecoilFitFcn fitFcn, const UInt_t nWorkers)
+{
+  const UInt_t nproc = TMath::Min(nWorkers, (UInt_t)jobv.size());
+
+  if(nproc<=1) {
+    TCanvas *c = MakeCanvas("cfit","cfit",800,600);
+    for(UInt_t ijob=0; ijob<jobv.size(); ijob++) fitFcn(jobv[ijob], c);
+    delete c;
+    return;
+  }
+
+  // one (job, result) record per fit, written at once (smaller than PIPE_BUF, so records of
+  // different workers do not interleave)
+  struct Record { UInt_t ijob; CRecoilFitPars res; };
+  int fd[2];
+  const int status = pipe(fd);
+  assert(status==0);
+  std::cout.flush();
+  fflush(stdout);
+
+  std::vector<pid_t> pidv;
+  for(UInt_t iproc=0; iproc<nproc; iproc++) {
+    pid_t pid = fork();
+    if(pid<0) {
+      // the bins of the missing workers are reported as unfinished below
+      std::cout << "Cannot start recoil fit worker " << iproc << "!" << std::endl;
+      break;
+    }
+    if(pid==0) {
+      close(fd[0]);
+      TCanvas *c = MakeCanvas("cfit","cfit",800,600);
+      for(UInt_t ijob=iproc; ijob<jobv.size(); ijob+=nproc) {
+        fitFcn(jobv[ijob], c);
+        Record rec;
+        rec.ijob = ijob;
+        rec.res  = jobv[ijob].res;
+        if(write(fd[1], &rec, sizeof(rec))!=sizeof(rec)) _exit(1);
+      }
+      close(fd[1]);
+      std::cout.flush();
+      fflush(stdout);
+      _exit(0);  // skip ROOT cleanup of the objects inherited from the parent
+    }
+    pidv.push_back(pid);
+  }
+  close(fd[1]);
+
+  UInt_t ndone=0;
+  Record rec;
+  while(read(fd[0], &rec, sizeof(rec))==sizeof(rec)) {
+    assert(rec.ijob<jobv.size());
+    jobv[rec.ijob].res = rec.res;
+    ndone++;
+  }
+  close(fd[0]);
+  UInt_t nfailed=0;
+  for(UInt_t iproc=0; iproc<pidv.size(); iproc++) {
+    int wstatus;
+    if(waitpid(pidv[iproc], &wstatus, 0)!=pidv[iproc] || !WIFEXITED(wstatus) || WEXITSTATUS(wstatus)!=0) nfailed++;
+  }
+  if(nfailed>0) {
+    std::cout << nfailed << " of " << pidv.size() << " recoil fit workers failed! Aborting..." << std::endl;
+    assert(0);
+  }
+  if(ndone!=jobv.size()) {
+    std::cout << "Only " << ndone << " of " << jobv.size() << " recoil fits finished! Aborting..." << std::endl;
+    assert(0);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+// all fits: moment seeds, then (warmStart) a pass seeded from the lower neighbour of each bin
+inline void runRecoilFits(std::vector<CRecoilFitJob> &jobv, RecoilFitFcn fitFcn, const UInt_t nWorkers, const Bool_t warmStart)
+{
+  runRecoilFitJobs(jobv, fitFcn, nWorkers);
+  if(!warmStart) return;
+
+  for(UInt_t ijob=0; ijob<jobv.size(); ijob++) {
+    CRecoilFitJob &job = jobv[ijob];
+    job.prev = job.res;
+    job.warmStart = (job.ibin>0 && ijob>0 && jobv[ijob-1].icomp==job.icomp && jobv[ijob-1].res.status==0);
+    if(job.warmStart) job.warmSeed = jobv[ijob-1].res;
+  }
+  std::vector<CRecoilFitJob> warmv;
+  std::vector<UInt_t> idxv;
+  for(UInt_t ijob=0; ijob<jobv.size(); ijob++) {
+    if(!jobv[ijob].warmStart) continue;
+    warmv.push_back(jobv[ijob]);
+    idxv.push_back(ijob);
+  }
+  runRecoilFitJobs(warmv, fitFcn, nWorkers);
+  for(UInt_t i=0; i<warmv.size(); i++) jobv[idxv[i]].res = warmv[i].res;
+}
+
+//--------------------------------------------------------------------------------------------------
+// copy the results of component icomp into the per-bin arrays of the macros
+inline void getRecoilFitResults(const std::vector<CRecoilFitJob> &jobv, const Int_t icomp,
+                                Double_t *meanArr,   Double_t *meanErrArr,
+                                Double_t *sigma0Arr, Double_t *sigma0ErrArr,
+                                Double_t *sigma1Arr, Double_t *sigma1ErrArr,
+                                Double_t *sigma2Arr, Double_t *sigma2ErrArr,
+                                Double_t *sigma3Arr, Double_t *sigma3ErrArr,
+                                Double_t *frac2Arr,  Double_t *frac2ErrArr,
+                                Double_t *frac3Arr,  Double_t *frac3ErrArr)
+{
+  Double_t *valArr[CRecoilFitPars::kNPar] = { meanArr, sigma0Arr, sigma1Arr, sigma2Arr, sigma3Arr, frac2Arr, frac3Arr };
+  Double_t *errArr[CRecoilFitPars::kNPar] = { meanErrArr, sigma0ErrArr, sigma1ErrArr, sigma2ErrArr, sigma3ErrArr, frac2ErrArr, frac3ErrArr };
+  for(UInt_t ijob=0; ijob<jobv.size(); ijob++) {
+    const CRecoilFitJob &job = jobv[ijob];
+    if(job.icomp!=icomp) continue;
+    for(Int_t ipar=0; ipar<CRecoilFitPars::kNPar; ipar++) {
+      // parameters the model does not have are left as they were, as before
+      if(job.model<2 && (ipar==CRecoilFitPars::kSigma0 || ipar==CRecoilFitPars::kSigma2 || ipar==CRecoilFitPars::kFrac2)) continue;
+      if(job.model<3 && (ipar==CRecoilFitPars::kSigma3 || ipar==CRecoilFitPars::kFrac3)) continue;
+      valArr[ipar][job.ibin] = job.res.val[ipar];
+      errArr[ipar][job.ibin] = job.res.err[ipar];
+    }
+  }
+}
+
+#endif
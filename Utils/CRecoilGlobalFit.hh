@@ -0,0 +1,337 @@
+#ifndef CRECOILGLOBALFIT_HH
+#define CRECOILGLOBALFIT_HH
+
+#include <TH1D.h>                   // 1D histograms
+#include <TF1.h>                    // 1D function
+#include <TGraph.h>                 // graph class
+#include <TMath.h>                  // ROOT math library
+#include <TString.h>                // ROOT string class
+#include <TFitResult.h>             // class to handle fit results
+#include <vector>                   // STL vector class
+#include <iostream>                 // standard I/O
+#include <cassert>                  // assertions
+
+#include "Math/IFunction.h"         // gradient function interface for the minimizer
+#include "Fit/Fitter.h"             // minimization and errors of a user function
+
+#include "CRecoilFit.hh"            // moment seeds of the per-bin distributions
+
+//
+// simultaneous fit of the pT dependent double Gaussian recoil model to all pT bins
+//
+//  * in bin i (pT = x_i) a component is mean(x) + (f(x) G(sigma2(x)) + (1-f(x)) G(sigma1(x))), with
+//    mean(x) a polynomial, sigma0, sigma1 and sigma2 quadratics (sigmaFunc) and
+//    f = (sigma0-sigma1)/(sigma2-sigma1), i.e. exactly the model RecoilCorrector draws from
+//  * the binned multinomial NLL of all histograms (u1 and u2, all pT bins) is minimized directly in the
+//    polynomial coefficients with an analytic gradient, so there is no per-bin fit and no second fit of
+//    the per-bin results; Hesse gives the full covariance of all coefficients
+//  * parameters are named "fcn<component><model>_<i>" (e.g. "fcnPFu1sigma1_0") after the TF1s of the
+//    fit macros; the result is written as "fitresPFglobal" and RecoilCorrector takes the blocks of the
+//    covariance it needs from it by name
+//  * the background fraction of a bin is fixed to the yield of its background template
+//
+class CRecoilGlobalFit : public ROOT::Math::IMultiGradFunction
+{
+public:
+  enum { kSigma1=0, kSigma2, kSigma0, kNSigma };
+
+  CRecoilGlobalFit():fNPar(0),fResult(0){}
+  CRecoilGlobalFit(const CRecoilGlobalFit &other):ROOT::Math::IMultiGradFunction(),
+  fComps(other.fComps),fBins(other.fBins),fNPar(other.fNPar),fResult(0){}
+  ~CRecoilGlobalFit() { delete fResult; }
+
+  ROOT::Math::IMultiGenFunction* Clone() const { return new CRecoilGlobalFit(*this); }
+  unsigned int NDim() const { return fNPar; }
+
+  // add one recoil component ("PFu1", ...): histograms and background templates of all pT bins,
+  // pT of each bin, number of mean polynomial coefficients (2 for pol1)
+  void addComponent(const char *name, const std::vector<TH1D*> &hv, const std::vector<TH1D*> &hbkgv,
+                    const Double_t *xval, const Int_t nbins, const Int_t nmean, const Bool_t sigOnly) {
+    Comp comp;
+    comp.name  = name;
+    comp.nmean = nmean;
+    comp.ipar  = fNPar;
+    fNPar += nmean + 3*kNSigma;
+    for(Int_t ibin=0; ibin<nbins; ibin++) {
+      Bin bin;
+      bin.icomp = fComps.size();
+      bin.x     = xval[ibin];
+      const TH1D *h = hv[ibin];
+      const Int_t nb = h->GetNbinsX();
+      bin.edges.resize(nb+1);
+      bin.obs.resize(nb);
+      bin.bkg.assign(nb,0);
+      for(Int_t k=0; k<=nb; k++) bin.edges[k] = h->GetXaxis()->GetBinLowEdge(k+1);
+      Double_t nobs=0, nbkg=0;
+      for(Int_t k=0; k<nb; k++) { bin.obs[k] = h->GetBinContent(k+1); nobs += bin.obs[k]; }
+      if(!sigOnly && hbkgv[ibin]) {
+        for(Int_t k=0; k<nb; k++) { bin.bkg[k] = TMath::Max(hbkgv[ibin]->GetBinContent(k+1),0.); nbkg += bin.bkg[k]; }
+      }
+      bin.fbkg = (nobs>0 && nbkg>0) ? TMath::Min(nbkg/nobs, 0.99) : 0;
+      for(Int_t k=0; k<nb; k++) bin.bkg[k] = (nbkg>0) ? bin.bkg[k]/nbkg : 0;
+      comp.x.push_back(xval[ibin]);
+      comp.seedMean.push_back(0); comp.seedSigma1.push_back(0); comp.seedSigma2.push_back(0); comp.seedN.push_back(nobs);
+      momentSeed(h, comp.seedMean.back(), comp.seedSigma1.back(), comp.seedSigma2.back());
+      fBins.push_back(bin);
+    }
+    fComps.push_back(comp);
+  }
+
+  // name of parameter ipar
+  TString parName(const UInt_t ipar) const {
+    for(UInt_t ic=0; ic<fComps.size(); ic++) {
+      const Comp &comp = fComps[ic];
+      const Int_t i = Int_t(ipar) - comp.ipar;
+      if(i<0 || i>=comp.nmean+3*kNSigma) continue;
+      if(i<comp.nmean) return TString::Format("fcn%smean_%i", comp.name.Data(), i);
+      static const char* snames[kNSigma] = { "sigma1", "sigma2", "sigma0" };
+      return TString::Format("fcn%s%s_%i", comp.name.Data(), snames[(i-comp.nmean)/3], (i-comp.nmean)%3);
+    }
+    return "";
+  }
+
+  // minimize the NLL from the moment seeds, with Hesse errors; returns the fit status (0 = OK)
+  Int_t fit() {
+    std::vector<Double_t> start(fNPar,0);
+    for(UInt_t ic=0; ic<fComps.size(); ic++) seed(fComps[ic], &start[fComps[ic].ipar]);
+
+    // the analytic gradient must agree with the NLL it is minimized with
+    const Double_t gdev = checkGradient(&start[0]);
+    if(gdev>1e-4) std::cout << "Global recoil fit: analytic gradient deviates from finite differences by " << gdev << "!" << std::endl;
+
+    ROOT::Fit::Fitter fitter;
+    fitter.Config().SetMinimizer("Minuit2","Migrad");
+    fitter.Config().SetParabErrors(true);
+    fitter.Config().MinimizerOptions().SetErrorDef(0.5);
+    fitter.Config().MinimizerOptions().SetPrintLevel(-1);
+    fitter.SetFCN(*this, &start[0]);
+    for(UInt_t ipar=0; ipar<fNPar; ipar++) {
+      fitter.Config().ParSettings(ipar).SetName(parName(ipar).Data());
+      fitter.Config().ParSettings(ipar).SetStepSize(0.01*TMath::Max(TMath::Abs(start[ipar]),1e-3));
+    }
+    fitter.FitFCN();
+    delete fResult;
+    fResult = new TFitResult(fitter.Result());
+    fResult->SetName("fitresPFglobal");
+    std::cout << "Global recoil fit: status " << fResult->Status() << ", NLL " << fResult->MinFcnValue()
+              << ", " << fResult->NTotalParameters() << " parameters" << std::endl;
+    return fResult->Status();
+  }
+
+  const TFitResult* result() const { return fResult; }
+
+  // largest relative difference between the analytic gradient and central finite differences of the NLL at par
+  Double_t checkGradient(const Double_t *par) const {
+    std::vector<Double_t> grad(fNPar,0), p(par, par+fNPar);
+    nll(par, &grad[0]);
+    Double_t maxdev = 0;
+    for(UInt_t ipar=0; ipar<fNPar; ipar++) {
+      const Double_t h = 1e-5*TMath::Max(TMath::Abs(par[ipar]),1e-2);
+      p[ipar] = par[ipar] + h; const Double_t up = nll(&p[0], 0);
+      p[ipar] = par[ipar] - h; const Double_t dn = nll(&p[0], 0);
+      p[ipar] = par[ipar];
+      const Double_t num = (up-dn)/(2*h);
+      const Double_t dev = TMath::Abs(grad[ipar]-num)/TMath::Max(TMath::Abs(grad[ipar])+TMath::Abs(num), 1e-6);
+      if(dev>maxdev) maxdev = dev;
+    }
+    return maxdev;
+  }
+
+  // copy the fitted coefficients of fcn (named as its parameters, e.g. "fcnPFu1sigma1") into fcn,
+  // with chi2 and NDF of fcn against the per-bin estimates in gr for the plots
+  void setFcn(TF1 *fcn, const TGraph *gr) const {
+    assert(fResult);
+    for(Int_t i=0; i<fcn->GetNpar(); i++) {
+      const Int_t ipar = fResult->Index(TString::Format("%s_%i", fcn->GetName(), i).Data());
+      if(ipar<0) continue;
+      fcn->SetParameter(i, fResult->Parameter(ipar));
+      fcn->SetParError(i, fResult->ParError(ipar));
+    }
+    fcn->SetChisquare(gr->Chisquare(fcn));
+    fcn->SetNDF(TMath::Max(gr->GetN()-fcn->GetNpar(), 1));
+  }
+
+  // per-bin moment estimates of component icomp (the seeds) in the arrays of the fit macros
+  void getSeeds(const Int_t icomp,
+                Double_t *meanArr,   Double_t *meanErrArr,
+                Double_t *sigma0Arr, Double_t *sigma0ErrArr,
+                Double_t *sigma1Arr, Double_t *sigma1ErrArr,
+                Double_t *sigma2Arr, Double_t *sigma2ErrArr,
+                Double_t *frac2Arr,  Double_t *frac2ErrArr) const {
+    const Comp &comp = fComps[icomp];
+    for(UInt_t ibin=0; ibin<comp.seedMean.size(); ibin++) {
+      const Double_t s1 = comp.seedSigma1[ibin], s2 = comp.seedSigma2[ibin];
+      const Double_t rootN = TMath::Sqrt(TMath::Max(comp.seedN[ibin],1.));
+      meanArr[ibin]   = comp.seedMean[ibin];  meanErrArr[ibin]   = TMath::Sqrt(0.5*(s1*s1+s2*s2))/rootN;
+      sigma0Arr[ibin] = 0.5*(s1+s2);          sigma0ErrArr[ibin] = sigma0Arr[ibin]/(TMath::Sqrt(2.)*rootN);
+      sigma1Arr[ibin] = s1;                   sigma1ErrArr[ibin] = s1/(TMath::Sqrt(2.)*rootN);
+      sigma2Arr[ibin] = s2;                   sigma2ErrArr[ibin] = s2/(TMath::Sqrt(2.)*rootN);
+      frac2Arr[ibin]  = 0.5;                  frac2ErrArr[ibin]  = 0;
+    }
+  }
+
+  // NLL and its gradient (grad may be 0)
+  Double_t nll(const Double_t *par, Double_t *grad) const {
+    const Double_t kMinSigma = 1e-3;  // lower bound of the widths (and of |sigma2-sigma1|)
+    if(grad) for(UInt_t i=0; i<fNPar; i++) grad[i] = 0;
+    Double_t sum=0;
+    std::vector<Double_t> cdf[2], pdf[2];
+    for(UInt_t ib=0; ib<fBins.size(); ib++) {
+      const Bin  &bin  = fBins[ib];
+      const Comp &comp = fComps[bin.icomp];
+      const Double_t *p = par + comp.ipar;
+      const Double_t  x = bin.x;
+
+      //
+      // model parameters of the bin
+      //
+      Double_t mean=0, xn=1;
+      for(Int_t i=0; i<comp.nmean; i++) { mean += p[i]*xn; xn *= x; }
+      Double_t sig[kNSigma];
+      Bool_t   clamped[kNSigma];
+      for(Int_t is=0; is<kNSigma; is++) {
+        const Double_t *q = p + comp.nmean + 3*is;
+        sig[is] = q[0]*x*x + q[1]*x + q[2];
+        clamped[is] = (sig[is]<kMinSigma);
+        if(clamped[is]) sig[is] = kMinSigma;
+      }
+      Double_t ds = sig[kSigma2] - sig[kSigma1];
+      if(TMath::Abs(ds)<kMinSigma) ds = (ds<0) ? -kMinSigma : kMinSigma;
+      Double_t frac = (sig[kSigma0]-sig[kSigma1])/ds;
+      const Bool_t fclamped = (frac<0 || frac>1);
+      frac = TMath::Min(TMath::Max(frac,0.),1.);
+      // df/dsigma for sigma1, sigma2, sigma0
+      const Double_t df[kNSigma] = { fclamped ? 0 : (sig[kSigma0]-sig[kSigma2])/(ds*ds),
+                                     fclamped ? 0 : -(sig[kSigma0]-sig[kSigma1])/(ds*ds),
+                                     fclamped ? 0 : 1./ds };
+
+      //
+      // Gaussian CDFs at the bin edges: P(bin k) = cdf[k+1]-cdf[k], dP/dmean and dP/dsigma from the pdfs
+      //
+      const UInt_t ne = bin.edges.size();
+      for(Int_t ig=0; ig<2; ig++) {
+        const Double_t s = sig[ig==0 ? kSigma1 : kSigma2];
+        cdf[ig].resize(ne);
+        pdf[ig].resize(ne);
+        for(UInt_t k=0; k<ne; k++) {
+          const Double_t z = (bin.edges[k]-mean)/s;
+          cdf[ig][k] = 0.5*TMath::Erfc(-z/TMath::Sqrt2());
+          pdf[ig][k] = TMath::Exp(-0.5*z*z)/TMath::Sqrt(TMath::TwoPi());
+        }
+      }
+      const Double_t s1 = sig[kSigma1], s2 = sig[kSigma2];
+      // normalization over the histogram range and its derivatives (mean, sigma1, sigma2, sigma0)
+      const Double_t S1 = cdf[0][ne-1]-cdf[0][0], S2 = cdf[1][ne-1]-cdf[1][0];
+      const Double_t S  = TMath::Max(frac*S2 + (1-frac)*S1, 1e-300);
+      Double_t dS[4];
+      {
+        const Double_t zl1 = (bin.edges[0]-mean)/s1, zh1 = (bin.edges[ne-1]-mean)/s1;
+        const Double_t zl2 = (bin.edges[0]-mean)/s2, zh2 = (bin.edges[ne-1]-mean)/s2;
+        const Double_t dS1mean = -(pdf[0][ne-1]-pdf[0][0])/s1, dS1sig = -(zh1*pdf[0][ne-1]-zl1*pdf[0][0])/s1;
+        const Double_t dS2mean = -(pdf[1][ne-1]-pdf[1][0])/s2, dS2sig = -(zh2*pdf[1][ne-1]-zl2*pdf[1][0])/s2;
+        dS[0] = frac*dS2mean + (1-frac)*dS1mean;
+        dS[1] = (clamped[kSigma1] ? 0 : (1-frac)*dS1sig) + (S2-S1)*df[kSigma1];
+        dS[2] = (clamped[kSigma2] ? 0 : frac*dS2sig)     + (S2-S1)*df[kSigma2];
+        dS[3] = (S2-S1)*df[kSigma0];
+      }
+
+      Double_t gbin[4] = { 0, 0, 0, 0 };  // dNLL/d(mean, sigma1, sigma2, sigma0) of the bin
+      for(UInt_t k=0; k+1<ne; k++) {
+        if(bin.obs[k]==0) continue;
+        const Double_t P1 = cdf[0][k+1]-cdf[0][k], P2 = cdf[1][k+1]-cdf[1][k];
+        const Double_t P  = frac*P2 + (1-frac)*P1;
+        const Double_t prob = TMath::Max((1-bin.fbkg)*P/S + bin.fbkg*bin.bkg[k], 1e-300);
+        sum -= bin.obs[k]*TMath::Log(prob);
+        if(!grad) continue;
+
+        const Double_t zl1 = (bin.edges[k]-mean)/s1, zh1 = (bin.edges[k+1]-mean)/s1;
+        const Double_t zl2 = (bin.edges[k]-mean)/s2, zh2 = (bin.edges[k+1]-mean)/s2;
+        const Double_t dP1mean = -(pdf[0][k+1]-pdf[0][k])/s1, dP1sig = -(zh1*pdf[0][k+1]-zl1*pdf[0][k])/s1;
+        const Double_t dP2mean = -(pdf[1][k+1]-pdf[1][k])/s2, dP2sig = -(zh2*pdf[1][k+1]-zl2*pdf[1][k])/s2;
+        const Double_t dP[4] = { frac*dP2mean + (1-frac)*dP1mean,
+                                 (clamped[kSigma1] ? 0 : (1-frac)*dP1sig) + (P2-P1)*df[kSigma1],
+                                 (clamped[kSigma2] ? 0 : frac*dP2sig)     + (P2-P1)*df[kSigma2],
+                                 (P2-P1)*df[kSigma0] };
+        const Double_t w = -bin.obs[k]/prob * (1-bin.fbkg)/S;
+        for(Int_t j=0; j<4; j++) gbin[j] += w*(dP[j] - P/S*dS[j]);
+      }
+      if(!grad) continue;
+
+      //
+      // chain rule to the polynomial coefficients
+      //
+      Double_t *g = grad + comp.ipar;
+      xn = 1;
+      for(Int_t i=0; i<comp.nmean; i++) { g[i] += gbin[0]*xn; xn *= x; }
+      for(Int_t is=0; is<kNSigma; is++) {
+        const Double_t gs = (is==kSigma0) ? gbin[3] : (clamped[is] ? 0 : gbin[1+is]);
+        if(is==kSigma0 && clamped[is]) continue;
+        Double_t *gq = g + comp.nmean + 3*is;
+        gq[0] += gs*x*x;
+        gq[1] += gs*x;
+        gq[2] += gs;
+      }
+    }
+    return sum;
+  }
+
+  void Gradient(const double *x, double *grad) const { nll(x, grad); }
+  void FdF(const double *x, double &f, double *df) const { f = nll(x, df); }
+
+protected:
+  struct Comp {
+    TString name;                   // component name ("PFu1", ...)
+    Int_t   nmean;                  // number of mean coefficients
+    Int_t   ipar;                   // index of its first parameter
+    std::vector<Double_t> x;        // pT of the bins
+    std::vector<Double_t> seedMean, seedSigma1, seedSigma2, seedN;  // per-bin moment estimates
+  };
+  struct Bin {
+    Int_t    icomp;                 // component of the histogram
+    Double_t x;                     // boson pT
+    Double_t fbkg;                  // fixed background fraction
+    std::vector<Double_t> edges, obs, bkg;  // bin edges, contents and normalized background template
+  };
+
+  double DoEval(const double *x) const { return nll(x, 0); }
+  double DoDerivative(const double *x, unsigned int icoord) const {
+    std::vector<Double_t> grad(fNPar);
+    nll(x, &grad[0]);
+    return grad[icoord];
+  }
+
+  // starting coefficients: polynomials through the per-bin moment estimates (sigma2 kept 10% above
+  // sigma1, so the fraction of the seed is defined)
+  static void seed(const Comp &comp, Double_t *start) {
+    const UInt_t n = comp.x.size();
+    std::vector<Double_t> s2(n), s0(n);
+    for(UInt_t i=0; i<n; i++) {
+      s2[i] = TMath::Max(comp.seedSigma2[i], 1.1*comp.seedSigma1[i]);
+      s0[i] = 0.5*(comp.seedSigma1[i]+s2[i]);
+    }
+    polyFit(comp.x, comp.seedMean,   comp.nmean-1, start, kFALSE);
+    polyFit(comp.x, comp.seedSigma1, 2, start + comp.nmean + 3*kSigma1, kTRUE);
+    polyFit(comp.x, s2,              2, start + comp.nmean + 3*kSigma2, kTRUE);
+    polyFit(comp.x, s0,              2, start + comp.nmean + 3*kSigma0, kTRUE);
+  }
+
+  // least squares polynomial of the given order (at most the number of bins - 1); coefficients in x^i
+  // order, or for the widths as the sigmaFunc {a,b,c} of a*x^2 + b*x + c
+  static void polyFit(const std::vector<Double_t> &x, const std::vector<Double_t> &y, const Int_t order,
+                      Double_t *coeff, const Bool_t isSigma) {
+    for(Int_t i=0; i<=order; i++) coeff[i] = 0;
+    const Int_t n = TMath::Min(order, Int_t(x.size())-1);
+    if(n<0) return;
+    TGraph gr(x.size(), &x[0], &y[0]);
+    TF1 fcn("_seedpol", TString::Format("pol%i",n), 0, 7000);
+    gr.Fit(&fcn, "QN0");
+    for(Int_t i=0; i<=n; i++) coeff[isSigma ? order-i : i] = fcn.GetParameter(i);
+  }
+
+  std::vector<Comp> fComps;         // recoil components
+  std::vector<Bin>  fBins;          // histograms of all components and pT bins
+  UInt_t      fNPar;                // number of parameters
+  TFitResult *fResult;              // result of the last fit
+};
+
+#endif
@@ -0,0 +1,164 @@
+#ifndef CRECOILMODEL_HH
+#define CRECOILMODEL_HH
+
+#include <TFile.h>                  // file handle class
+#include <TF1.h>                    // 1D function
+#include <TFitResult.h>             // class to handle fit results
+#include <TMath.h>                  // ROOT math library
+#include <TString.h>                // ROOT string class
+#include <iostream>                 // standard I/O
+#include <cstdio>                   // fopen(), fread(), fwrite()
+#include <cstring>                  // memset()
+#include <sys/stat.h>               // stat() for the modification times of the fit files
+#include <cassert>                  // assertions
+
+//
+// recoil model of one fit file as a flat, versioned struct
+//
+//  * the means (polN, N<=2) and widths (sigmaFunc) of u1 and u2 as a*x^2 + b*x + c with their
+//    fit ranges, and the covariance of the coefficients in the same {a,b,c} order
+//  * loadRecoilModel() converts the TF1s and fit results of a ROOT fit file; writeRecoilModel()
+//    and readRecoilModel() store the struct as is (native byte order), so loading a model is one
+//    fread with no ROOT dictionary, objects or TF1s
+//  * the recoil fit macros write the binary model next to the ROOT file, fits_<met>.rcm, and
+//    getRecoilModel() picks it up when given the ROOT file
+//
+struct CRecoilModel
+{
+  enum { kMagic=0x4D434552, kVersion=1 };  // "RECM"
+  enum { kU1mean=0, kU1sigma1, kU1sigma2, kU1sigma0, kU2mean, kU2sigma1, kU2sigma2, kU2sigma0, kNModels };
+
+  UInt_t   magic, version, size;     // file identification: kMagic, kVersion, sizeof(CRecoilModel)
+  Int_t    npar[kNModels];           // number of fitted coefficients
+  Double_t coeff[kNModels][3];       // {a,b,c} of a*x^2 + b*x + c
+  Double_t xmin[kNModels];           // fit range
+  Double_t xmax[kNModels];
+  Double_t cov[kNModels][3][3];      // covariance of {a,b,c}, zero for coefficients not fitted
+
+  Double_t eval(const Int_t im, const Double_t x) const { return (coeff[im][0]*x + coeff[im][1])*x + coeff[im][2]; }
+
+  // fit uncertainty of model im at x
+  Double_t err(const Int_t im, const Double_t x) const {
+    const Double_t df[3] = { x*x, x, 1 };
+    Double_t err2=0;
+    for(Int_t i=0; i<3; i++) {
+      err2 += df[i]*df[i]*cov[im][i][i];
+      for(Int_t j=i+1; j<3; j++) err2 += 2.0*df[i]*df[j]*cov[im][i][j];
+    }
+    assert(err2>=0);
+    return TMath::Sqrt(err2);
+  }
+};
+
+//--------------------------------------------------------------------------------------------------
+// covariance (npar x npar, row-major) of the coefficients of model name ("PFu1sigma1"): from its own
+// fit result "fitres<name>", or else the block of the parameters "fcn<name>_<i>" of the simultaneous
+// fit of all pT bins, "fitresPFglobal"
+inline void recoilCov(TFile &infile, const char *name, const Int_t npar, Double_t *cov)
+{
+  assert(npar<=3);
+  TFitResult *fs = (TFitResult*)infile.Get(TString("fitres")+name);
+  if(fs) {
+    for(Int_t i=0; i<npar; i++) {
+      for(Int_t j=0; j<npar; j++) cov[i*npar+j] = fs->GetCovarianceMatrix()[i][j];
+    }
+    delete fs;
+    return;
+  }
+  TFitResult *global = (TFitResult*)infile.Get("fitresPFglobal");
+  assert(global);
+  Int_t idx[3];
+  for(Int_t i=0; i<npar; i++) {
+    idx[i] = global->Index(TString::Format("fcn%s_%i",name,i).Data());
+    assert(idx[i]>=0);
+  }
+  for(Int_t i=0; i<npar; i++) {
+    for(Int_t j=0; j<npar; j++) cov[i*npar+j] = global->CovMatrix(idx[i],idx[j]);
+  }
+  delete global;
+}
+
+//--------------------------------------------------------------------------------------------------
+// model from the TF1s (and, if withCov, the fit results) of a recoil fit file
+inline void loadRecoilModel(const TString &fname, CRecoilModel &model, const Bool_t withCov)
+{
+  static const char* names[CRecoilModel::kNModels] = { "PFu1mean", "PFu1sigma1", "PFu1sigma2", "PFu1sigma0",
+                                                       "PFu2mean", "PFu2sigma1", "PFu2sigma2", "PFu2sigma0" };
+  memset(&model, 0, sizeof(model));
+  model.magic   = CRecoilModel::kMagic;
+  model.version = CRecoilModel::kVersion;
+  model.size    = sizeof(CRecoilModel);
+
+  TFile infile(fname);
+  assert(!infile.IsZombie());
+  for(Int_t im=0; im<CRecoilModel::kNModels; im++) {
+    TF1 *fcn = (TF1*)infile.Get(TString("fcn")+names[im]);
+    assert(fcn);
+    const Bool_t isMean = (im==CRecoilModel::kU1mean || im==CRecoilModel::kU2mean);
+    const Int_t  npar   = fcn->GetNpar();
+    if(npar>3 || (isMean && fcn->GetNumber()!=300+npar-1)) {
+      std::cout << "fcn" << names[im] << " in " << fname << " is not a polynomial of order <= 2! Aborting..." << std::endl;
+      assert(0);
+    }
+    // slot of parameter i in {a,b,c}: polN par[i] is the coefficient of x^i, sigmaFunc is {a,b,c}
+    Int_t slot[3];
+    for(Int_t i=0; i<npar; i++) slot[i] = isMean ? 2-i : i;
+
+    model.npar[im] = npar;
+    for(Int_t i=0; i<npar; i++) model.coeff[im][slot[i]] = fcn->GetParameter(i);
+    fcn->GetRange(model.xmin[im], model.xmax[im]);
+    delete fcn;
+
+    if(withCov) {
+      Double_t cov[9];
+      recoilCov(infile, names[im], npar, cov);
+      for(Int_t i=0; i<npar; i++) {
+        for(Int_t j=0; j<npar; j++) model.cov[im][slot[i]][slot[j]] = cov[i*npar+j];
+      }
+    }
+  }
+  infile.Close();
+}
+
+//--------------------------------------------------------------------------------------------------
+inline void writeRecoilModel(const TString &fname, const CRecoilModel &model)
+{
+  FILE *f = fopen(fname.Data(), "wb");
+  assert(f);
+  const size_t n = fwrite(&model, sizeof(model), 1, f);
+  fclose(f);
+  assert(n==1);
+}
+
+//--------------------------------------------------------------------------------------------------
+// kFALSE if fname is not a binary model of this version
+inline Bool_t readRecoilModel(const TString &fname, CRecoilModel &model)
+{
+  FILE *f = fopen(fname.Data(), "rb");
+  if(!f) return kFALSE;
+  const size_t n = fread(&model, sizeof(model), 1, f);
+  fclose(f);
+  return (n==1 && model.magic==CRecoilModel::kMagic && model.version==CRecoilModel::kVersion && model.size==sizeof(CRecoilModel));
+}
+
+//--------------------------------------------------------------------------------------------------
+// model of a binary (".rcm") or ROOT fit file; for a ROOT file the fits_<met>.rcm written next to it
+// by the fit macros is read instead if it is valid and not older than the ROOT file
+inline void getRecoilModel(const TString &fname, CRecoilModel &model, const Bool_t withCov)
+{
+  if(!fname.EndsWith(".rcm")) {
+    TString rcmfname(fname);
+    if(rcmfname.EndsWith(".root")) rcmfname.Replace(rcmfname.Length()-5, 5, ".rcm");
+    struct stat rootStat, rcmStat;
+    if(rcmfname!=fname && stat(rcmfname.Data(), &rcmStat)==0 && stat(fname.Data(), &rootStat)==0 &&
+       rcmStat.st_mtime>=rootStat.st_mtime && readRecoilModel(rcmfname, model)) return;
+    loadRecoilModel(fname, model, withCov);
+    return;
+  }
+  if(!readRecoilModel(fname, model)) {
+    std::cout << fname << " is not a recoil model of version " << CRecoilModel::kVersion << "! Aborting..." << std::endl;
+    assert(0);
+  }
+}
+
+#endif
@@ -0,0 +1,209 @@
+#ifndef CSUMWEIGHTS_HH
+#define CSUMWEIGHTS_HH
+
+#include <TString.h>                // ROOT string class
+#include <TFile.h>                  // file handle class
+#include <TTree.h>                  // class to access ntuples
+#include <TSystem.h>                // interface to OS
+#include <TH1.h>                    // histogram base class
+#include <vector>                   // STL vector class
+#include <map>                      // STL map class
+#include <string>                   // C++ string class
+#include <sstream>                  // class for parsing strings
+#include <fstream>                  // functions for file I/O
+#include <iostream>                 // standard I/O
+#include <iomanip>                  // functions to format standard I/O
+#include <cassert>                  // assertions
+#include <fcntl.h>                  // open
+#include <unistd.h>                 // write, close
+#include <sys/file.h>               // flock
+
+//
+// helper class to handle the MC normalization (sum of event weights) per input file
+//
+//  * sums are cached in a small text file (one line per input file) so that a re-run of a
+//    selection macro does not need to pre-scan the Bacon ntuples to normalize the MC
+//  * each line also carries a key of the weight configuration (e.g. the PU reweighting histograms,
+//    see key()), so sums made with other weights are not reused; the file is read and appended
+//    under a file lock, so parallel jobs can share it
+//  * on a cache miss the sums can be accumulated in the selection event loop itself ("single pass"):
+//    events are written with unnormalized weights and finalize() rescales the weight branches of
+//    the (much smaller) output ntuple once all input files of a sample are processed
+//
+class CSumWeights
+{
+public:
+  CSumWeights(const TString cache, const UInt_t nsums, const TString config=""):
+  fCache(cache),fConfig(config.Length()>0 ? config : TString("-")),fNSums(nsums),fSumv(nsums,0) { read(); }
+  ~CSumWeights(){}
+
+  // key of the weight inputs: 64-bit FNV-1a hash of the binning and contents of the histograms
+  static TString key(const TH1 *h1, const TH1 *h2=0, const TH1 *h3=0) {
+    unsigned long long hash = 14695981039346656037ULL;
+    const TH1 *hv[3] = { h1, h2, h3 };
+    for(UInt_t ih=0; ih<3; ih++) {
+      const TH1 *h = hv[ih];
+      std::vector<Double_t> valv;
+      valv.push_back(h ? h->GetNbinsX() : -1);
+      for(Int_t i=1; h && i<=h->GetNbinsX()+1; i++) valv.push_back(h->GetXaxis()->GetBinLowEdge(i));
+      for(Int_t i=0; h && i<=h->GetNbinsX()+1; i++) valv.push_back(h->GetBinContent(i));
+      const unsigned char *p = (const unsigned char*)&valv[0];
+      for(size_t i=0; i<valv.size()*sizeof(Double_t); i++) { hash ^= p[i]; hash *= 1099511628211ULL; }
+    }
+    return TString::Format("%016llx",hash);
+  }
+
+  // look up sums of weights for an input file, returns kTRUE if found in the cache
+  Bool_t lookup(const TString fname) {
+    std::map<TString, std::vector<Double_t> >::const_iterator it = fCachev.find(fname);
+    if(it==fCachev.end()) return kFALSE;
+    fSumv = it->second;
+    return kTRUE;
+  }
+
+  void     clear()                             { fSumv.assign(fNSums,0); }
+  void     add(const UInt_t i, const Double_t w) { fSumv[i]+=w; }
+  Double_t sum(const UInt_t i) const             { return fSumv[i]; }
+
+  // normalization factor to get event weight per 1/fb (same convention as xsec/totalWeight)
+  Double_t norm(const UInt_t i, const Double_t xsec) const { return (xsec>0 && fSumv[i]>0) ? xsec/fSumv[i] : 1; }
+
+  // record sums of weights for an input file and append them to the cache
+  void store(const TString fname) {
+    fCachev[fname] = fSumv;
+    std::ostringstream ss;
+    ss << fname << " " << fConfig;
+    for(UInt_t i=0; i<fNSums; i++) ss << " " << std::setprecision(17) << fSumv[i];
+    ss << std::endl;
+    const std::string line = ss.str();
+    const int fd = open(fCache.Data(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if(fd<0) {
+      std::cout << "CSumWeights: cannot write cache " << fCache << std::endl;
+      return;
+    }
+    flock(fd, LOCK_EX);
+    if(write(fd, line.c_str(), line.size())!=(ssize_t)line.size())
+      std::cout << "CSumWeights: cannot write cache " << fCache << std::endl;
+    flock(fd, LOCK_UN);
+    close(fd);
+  }
+
+  //
+  // single pass bookkeeping: each input file contributes a contiguous range of output entries
+  // with one scale factor per weight branch (1 if the weights were already normalized)
+  //
+  void addRange(const Long64_t first, const std::vector<Double_t> &factorv) {
+    fFirstv.push_back(first);
+    fFactorv.push_back(factorv);
+  }
+  void clearRanges() { fFirstv.clear(); fFactorv.clear(); }
+
+  // copy "Events" from infname to outfname, scaling the listed Float_t weight branches
+  void finalize(const TString infname, const TString outfname, const std::vector<TString> &branchv) {
+    TFile *infile = TFile::Open(infname);
+    assert(infile);
+    TTree *intree = (TTree*)infile->Get("Events");
+    assert(intree);
+    finalize(intree, outfname, branchv);
+    infile->Close();
+    delete infile;
+    gSystem->Unlink(infname);
+  }
+
+  // same for an already opened tree (or chain of partial ntuples)
+  void finalize(TTree *intree, const TString outfname, const std::vector<TString> &branchv) {
+    std::vector<Float_t> valv(branchv.size(),0);
+    for(UInt_t i=0; i<branchv.size(); i++) intree->SetBranchAddress(branchv[i], &valv[i]);
+
+    TFile *outfile = new TFile(outfname,"RECREATE");
+    TTree *outtree = intree->CloneTree(0);
+    UInt_t ifile=0;
+    for(Long64_t ientry=0; ientry<intree->GetEntries(); ientry++) {
+      intree->GetEntry(ientry);
+      while(ifile+1<fFirstv.size() && ientry>=fFirstv[ifile+1]) ifile++;
+      for(UInt_t i=0; i<branchv.size(); i++) valv[i] *= fFactorv[ifile][i];
+      outtree->Fill();
+    }
+    outfile->Write();
+    outfile->Close();
+    delete outfile;
+    clearRanges();
+  }
+
+  //
+  // entry-range partitions: a job processing only part of a sample records, for each input file it
+  // touched, the first output entry, the cross section and the partial sums of weights in a small
+  // "SumWeights" tree (weight branch names in the title); mergeSelection.C adds up the partial sums
+  // of all jobs and normalizes the merged ntuple
+  //
+  void addChunk(const UInt_t ifile, const Long64_t first, const Double_t xsec, const Bool_t stream) {
+    fChunkFilev.push_back(ifile);
+    fChunkFirstv.push_back(first);
+    fChunkXsecv.push_back(xsec);
+    fChunkStreamv.push_back(stream);
+    fChunkSumv.push_back(fSumv);
+  }
+  void writeChunks(const std::vector<TString> &branchv) {
+    TString title;
+    for(UInt_t i=0; i<branchv.size(); i++) title += (i>0 ? ":" : "") + branchv[i];
+    UInt_t   ifile;
+    Long64_t first;
+    Double_t xsec;
+    Bool_t   stream;
+    std::vector<Double_t> sumv(fNSums,0);
+    TTree *sumTree = new TTree("SumWeights",title);
+    sumTree->Branch("ifile",  &ifile,   "ifile/i");                   // input file index in the sample
+    sumTree->Branch("first",  &first,   "first/L");                   // first output entry of this input file
+    sumTree->Branch("xsec",   &xsec,    "xsec/D");                    // cross section of input file
+    sumTree->Branch("stream", &stream,  "stream/O");                  // weights written unnormalized?
+    sumTree->Branch("sumw",   &sumv[0], Form("sumw[%i]/D",fNSums));   // partial sums of weights
+    for(UInt_t ichunk=0; ichunk<fChunkFilev.size(); ichunk++) {
+      ifile  = fChunkFilev[ichunk];
+      first  = fChunkFirstv[ichunk];
+      xsec   = fChunkXsecv[ichunk];
+      stream = fChunkStreamv[ichunk];
+      for(UInt_t i=0; i<fNSums; i++) sumv[i] = fChunkSumv[ichunk][i];
+      sumTree->Fill();
+    }
+    sumTree->Write();
+    fChunkFilev.clear(); fChunkFirstv.clear(); fChunkXsecv.clear(); fChunkStreamv.clear(); fChunkSumv.clear();
+  }
+
+protected:
+  void read() {
+    const int fd = open(fCache.Data(), O_RDONLY);
+    if(fd<0) return;
+    flock(fd, LOCK_SH);
+    std::ifstream ifs(fCache.Data());
+    std::string line;
+    while(ifs.is_open() && getline(ifs,line)) {
+      if(line.empty() || line[0]=='#') continue;
+      std::stringstream ss(line);
+      std::string fname, config;
+      ss >> fname >> config;
+      if(TString(config.c_str())!=fConfig) continue;
+      std::vector<Double_t> sumv(fNSums,0);
+      UInt_t n=0;
+      while(n<fNSums && (ss >> sumv[n])) n++;
+      if(n==fNSums) fCachev[TString(fname.c_str())] = sumv;
+    }
+    ifs.close();
+    flock(fd, LOCK_UN);
+    close(fd);
+  }
+
+  TString                                   fCache;    // cache file name
+  TString                                   fConfig;   // key of the weight configuration
+  UInt_t                                    fNSums;    // number of weight sums per input file
+  std::vector<Double_t>                     fSumv;     // sums of weights of current input file
+  std::map<TString, std::vector<Double_t> > fCachev;   // cached sums of weights per input file
+  std::vector<Long64_t>                     fFirstv;   // first output entry per input file
+  std::vector<std::vector<Double_t> >       fFactorv;  // weight scale factors per input file
+  std::vector<UInt_t>                       fChunkFilev;    // input file index per partial chunk
+  std::vector<Long64_t>                     fChunkFirstv;   // first output entry per partial chunk
+  std::vector<Double_t>                     fChunkXsecv;    // cross section per partial chunk
+  std::vector<Bool_t>                       fChunkStreamv;  // unnormalized weights per partial chunk
+  std::vector<std::vector<Double_t> >       fChunkSumv;     // partial sums of weights per chunk
+};
+
+#endif
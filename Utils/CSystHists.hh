@@ -0,0 +1,125 @@
+#ifndef CSYSTHISTS_HH
+#define CSYSTHISTS_HH
+
+#include <TH1D.h>                   // histogram class
+#include <TString.h>                // ROOT string class
+#include <vector>                   // STL vector class
+#include <cassert>                  // assertions
+
+//
+// histograms of a set of observables for a set of event weight variations of one sample
+//
+//  * variations are given once as histogram name suffixes ("" for the nominal weight), observables
+//    are booked by index; book() creates the histogram h<sample><observable><suffix> of each variation
+//  * fill() looks up the bin of an observable once and adds the weights of all variations to one
+//    contiguous row of a (bin x variation) matrix, sums of squared weights are kept alongside
+//  * flush() adds the matrices to the histograms (contents, errors, entries and statistics as with
+//    TH1::Fill) and clears them, so it must be called before the histograms are used
+//
+class CSystHists
+{
+public:
+  CSystHists(const TString &sample, const Int_t nvar, const TString *suffixv):fSample(sample),fSuffixv(suffixv,suffixv+nvar){}
+  ~CSystHists(){}
+
+  void book(const Int_t iobs, const TString &name, const Int_t nbins, const Double_t *edges) {
+    std::vector<TH1D*> histv;
+    for(UInt_t ivar=0; ivar<fSuffixv.size(); ivar++)
+      histv.push_back(new TH1D("h"+fSample+name+fSuffixv[ivar],"",nbins,edges));
+    add(iobs,histv);
+  }
+  void book(const Int_t iobs, const TString &name, const Int_t nbins, const Double_t xmin, const Double_t xmax) {
+    std::vector<TH1D*> histv;
+    for(UInt_t ivar=0; ivar<fSuffixv.size(); ivar++)
+      histv.push_back(new TH1D("h"+fSample+name+fSuffixv[ivar],"",nbins,xmin,xmax));
+    add(iobs,histv);
+  }
+
+  Int_t nvar() const { return fSuffixv.size(); }
+  TH1D* hist(const Int_t iobs, const Int_t ivar=0) const { return fObsv[iobs].histv[ivar]; }
+
+  // w holds the event weight of each variation
+  void fill(const Int_t iobs, const Double_t x, const Double_t *w) {
+    Obs &obs = fObsv[iobs];
+    const Int_t    nv   = fSuffixv.size();
+    const Int_t    ibin = obs.histv[0]->GetXaxis()->FindFixBin(x);
+    Double_t      *sumw = &obs.sumw[ibin*nv];
+    Double_t      *sumw2= &obs.sumw2[ibin*nv];
+    for(Int_t iv=0; iv<nv; iv++) {
+      sumw[iv]  += w[iv];
+      sumw2[iv] += w[iv]*w[iv];
+    }
+    obs.nfill++;
+    // statistics of in-range fills, as TH1::Fill
+    if(ibin==0 || ibin>obs.nbins) return;
+    Double_t *stats = &obs.stats[0];
+    for(Int_t iv=0; iv<nv; iv++) {
+      const Double_t wx = w[iv]*x;
+      stats[kNStats*iv+0] += w[iv];
+      stats[kNStats*iv+1] += w[iv]*w[iv];
+      stats[kNStats*iv+2] += wx;
+      stats[kNStats*iv+3] += wx*x;
+    }
+  }
+
+  void flush() {
+    const Int_t nv = fSuffixv.size();
+    for(UInt_t iobs=0; iobs<fObsv.size(); iobs++) {
+      Obs &obs = fObsv[iobs];
+      if(obs.histv.empty() || obs.nfill==0) continue;
+      for(Int_t iv=0; iv<nv; iv++) {
+        TH1D *h = obs.histv[iv];
+        Double_t stats[kNStats];
+        h->GetStats(stats);
+        const Double_t entries = h->GetEntries();
+        for(Int_t ibin=0; ibin<=obs.nbins+1; ibin++) {
+          h->AddBinContent(ibin, obs.sumw[ibin*nv+iv]);
+          h->GetSumw2()->fArray[ibin] += obs.sumw2[ibin*nv+iv];
+        }
+        for(Int_t k=0; k<kNStats; k++) stats[k] += obs.stats[kNStats*iv+k];
+        h->PutStats(stats);
+        h->SetEntries(entries+obs.nfill);
+      }
+      obs.sumw.assign(obs.sumw.size(),0);
+      obs.sumw2.assign(obs.sumw2.size(),0);
+      obs.stats.assign(obs.stats.size(),0);
+      obs.nfill = 0;
+    }
+  }
+
+  // write all variations of an observable to the current directory
+  void write(const Int_t iobs) const {
+    for(UInt_t ivar=0; ivar<fSuffixv.size(); ivar++) hist(iobs,ivar)->Write();
+  }
+
+protected:
+  enum { kNStats=4 };  // sum of w, w^2, w*x, w*x^2
+
+  struct Obs {
+    Obs():nbins(0),nfill(0){}
+    std::vector<TH1D*>    histv;
+    Int_t                 nbins;
+    Double_t              nfill;
+    std::vector<Double_t> sumw, sumw2;  // (nbins+2) x nvar, row per bin
+    std::vector<Double_t> stats;        // kNStats per variation
+  };
+
+  void add(const Int_t iobs, const std::vector<TH1D*> &histv) {
+    assert(iobs>=0);
+    if(iobs>=(Int_t)fObsv.size()) fObsv.resize(iobs+1);
+    Obs &obs = fObsv[iobs];
+    assert(obs.histv.empty());
+    for(UInt_t ivar=0; ivar<histv.size(); ivar++) histv[ivar]->Sumw2();
+    obs.histv = histv;
+    obs.nbins = histv[0]->GetNbinsX();
+    obs.sumw.assign((obs.nbins+2)*histv.size(),0);
+    obs.sumw2.assign((obs.nbins+2)*histv.size(),0);
+    obs.stats.assign(kNStats*histv.size(),0);
+  }
+
+  TString               fSample;
+  std::vector<TString>  fSuffixv;
+  std::vector<Obs>      fObsv;
+};
+
+#endif
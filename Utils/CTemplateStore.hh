@@ -0,0 +1,219 @@
+#ifndef CTEMPLATESTORE_HH
+#define CTEMPLATESTORE_HH
+
+#include <TSystem.h>                // interface to OS
+#include <TFile.h>                  // file handle class
+#include <TDirectory.h>             // ROOT file directory
+#include <TNamed.h>                 // named string object
+#include <TTree.h>                  // class to access ntuples
+#include <TH1D.h>                   // 1D histograms
+#include <TString.h>                // ROOT string class
+#include <vector>                   // STL vector class
+#include <cassert>                  // assertions
+
+#include "CBinning.hh"              // fast bin lookup
+#include "CProbeStore.hh"           // pass/fail probe storage
+#include "CFitCache.hh"             // FNV-1a hash of the inputs
+
+//
+// MC mass templates of all tag-and-probe projections, built in one pass and read back per bin
+//
+//  * CTemplateBuilder fills the pass/fail templates of every projection (pt, eta, phi, etapt, etaphi,
+//    npv) for all, positive and negative probes at once, so one loop over the MC serves every
+//    projection and both charges
+//  * the store is a ROOT file with one directory per charge ("all", "pos", "neg") holding the
+//    <prefix><pass|fail><projection>_<bin> histograms, an "Index" tree (charge, projection, bin,
+//    pass, entries, sum of weights) with one entry per template, and an "Inputs" key: the hash of
+//    the MC file, binning, mass range and PU weights the templates were made from
+//  * CTemplateStore opens the file on first use and reads a template only when it is asked for,
+//    so a fit only loads the bin it needs; a store whose Inputs key matches is reused as is
+//
+namespace templates
+{
+  enum { kAll=0, kPos, kNeg, kNCharge };
+  enum { kPt=0, kEta, kPhi, kEtaPt, kEtaPhi, kNPV, kNProj };
+
+  inline const char* projName(const Int_t iproj) {
+    static const char* names[kNProj] = { "pt", "eta", "phi", "etapt", "etaphi", "npv" };
+    return names[iproj];
+  }
+  inline const char* chargeDir(const Int_t icharge) {
+    static const char* names[kNCharge] = { "all", "pos", "neg" };
+    return names[icharge];
+  }
+  inline Int_t projIndex(const TString &name) {
+    for(Int_t i=0; i<kNProj; i++) { if(name.CompareTo(projName(i))==0) return i; }
+    return -1;
+  }
+  // charge requirement as in the fits: 0 (none), +1 (q>=0), -1 (q<=0)
+  inline Int_t chargeIndex(const Int_t charge) { return (charge>0) ? kPos : ((charge<0) ? kNeg : kAll); }
+
+  inline TString histName(const TString &prefix, const Int_t iproj, const Int_t ibin, const Bool_t pass) {
+    return TString::Format("%s%s%s_%i", prefix.Data(), pass ? "pass" : "fail", projName(iproj), ibin);
+  }
+}
+
+class CTemplateBuilder
+{
+public:
+  CTemplateBuilder(const std::vector<Double_t> &ptEdgesv, const std::vector<Double_t> &etaEdgesv,
+                   const std::vector<Double_t> &phiEdgesv, const std::vector<Double_t> &npvEdgesv, const Bool_t doAbsEta,
+                   const Double_t fitMassLo, const Double_t fitMassHi, const Int_t nmPass, const Int_t nmFail):
+  fPtBins(ptEdgesv),fEtaBins(etaEdgesv,doAbsEta),fPhiBins(phiEdgesv),fNPVBins(npvEdgesv),
+  fEtaPtBins(fEtaBins,fPtBins),fEtaPhiBins(fEtaBins,fPhiBins),
+  fDoAbsEta(doAbsEta),fMassLo(fitMassLo),fMassHi(fitMassHi),fNmPass(nmPass),fNmFail(nmFail)
+  {
+    const Int_t nbins[templates::kNProj] = { fPtBins.nbins(), fEtaBins.nbins(), fPhiBins.nbins(),
+                                             fEtaPtBins.nbins(), fEtaPhiBins.nbins(), fNPVBins.nbins() };
+    for(Int_t iq=0; iq<templates::kNCharge; iq++) {
+      for(Int_t ip=0; ip<templates::kNProj; ip++)
+        fStores.push_back(CProbeStore(nbins[ip], fitMassLo, fitMassHi, nmPass, nmFail));
+    }
+  }
+  ~CTemplateBuilder(){}
+
+  // one MC probe, goes into the all-charge templates and those of its charge
+  void fill(const Float_t mass, const Double_t pt, const Double_t eta, const Double_t phi, const Double_t npv,
+            const Int_t q, const Bool_t pass, const Double_t w) {
+    const Int_t ipt  = fPtBins.find(pt);   if(ipt<0)  return;
+    const Int_t ieta = fEtaBins.find(eta); if(ieta<0) return;
+    const Int_t iphi = fPhiBins.find(phi); if(iphi<0) return;
+    const Int_t inpv = fNPVBins.find(npv); if(inpv<0) return;
+    const Int_t ibin[templates::kNProj] = { ipt, ieta, iphi, fEtaPtBins.index(ieta,ipt), fEtaPhiBins.index(ieta,iphi), inpv };
+    for(Int_t iq=0; iq<templates::kNCharge; iq++) {
+      if(iq==templates::kPos && q<0) continue;
+      if(iq==templates::kNeg && q>0) continue;
+      for(Int_t ip=0; ip<templates::kNProj; ip++)
+        fStores[iq*templates::kNProj+ip].fill(ibin[ip], pass, mass, w);
+    }
+  }
+
+  // key of the templates made from infilename (name, size, modification time) with this binning
+  TString inputs(const TString &infilename, const TH1D *puWeights, const TString &prefix) const {
+    CFitCache key;
+    Long_t id=0, flags=0, modtime=0;
+    Long64_t size=0;
+    gSystem->GetPathInfo(infilename, &id, &size, &flags, &modtime);
+    key.add(infilename); key.add(&size,sizeof(size)); key.add(&modtime,sizeof(modtime));
+    key.add(prefix);
+    addEdges(key, fPtBins); addEdges(key, fEtaBins); addEdges(key, fPhiBins); addEdges(key, fNPVBins);
+    key.add(Int_t(fDoAbsEta));
+    key.add(fMassLo); key.add(fMassHi); key.add(fNmPass); key.add(fNmFail);
+    key.add((const TH1*)puWeights);
+    return key.key();
+  }
+
+  // write all templates and the index to fname
+  void write(const TString &fname, const TString &prefix, const TString &inputs) const {
+    TFile outfile(fname, "RECREATE");
+    assert(!outfile.IsZombie());
+    Int_t charge, proj, ibin, pass;
+    UInt_t entries;
+    Double_t sumw;
+    TTree *index = new TTree("Index","template index");  // owned by outfile
+    index->Branch("charge", &charge, "charge/I");
+    index->Branch("proj",   &proj,   "proj/I");
+    index->Branch("ibin",   &ibin,   "ibin/I");
+    index->Branch("pass",   &pass,   "pass/I");
+    index->Branch("entries",&entries,"entries/i");
+    index->Branch("sumw",   &sumw,   "sumw/D");
+    for(charge=0; charge<templates::kNCharge; charge++) {
+      TDirectory *dir = outfile.mkdir(templates::chargeDir(charge));
+      dir->cd();
+      for(proj=0; proj<templates::kNProj; proj++) {
+        const CProbeStore &store = fStores[charge*templates::kNProj+proj];
+        for(ibin=0; ibin<store.nbins(); ibin++) {
+          for(pass=1; pass>=0; pass--) {
+            TH1D h(templates::histName(prefix,proj,ibin,pass), "", pass ? fNmPass : fNmFail, fMassLo, fMassHi);
+            h.SetDirectory(0);
+            store.fillHist(ibin, pass, &h);
+            h.Write();
+            entries = store.entries(ibin,pass);
+            sumw    = h.Integral(0,h.GetNbinsX()+1);
+            index->Fill();
+          }
+        }
+      }
+    }
+    outfile.cd();
+    index->Write();
+    TNamed("Inputs", inputs.Data()).Write();
+    outfile.Close();
+  }
+
+protected:
+  static void addEdges(CFitCache &key, const CBinning &bins) {
+    key.add(Int_t(bins.nbins()));
+    for(UInt_t i=0; i<bins.edges().size(); i++) key.add(bins.edges()[i]);
+  }
+
+  CBinning   fPtBins, fEtaBins, fPhiBins, fNPVBins;  // bin lookup per variable
+  CBinning2D fEtaPtBins, fEtaPhiBins;                // 2D bin lookup
+  Bool_t     fDoAbsEta;                              // bin in |eta|?
+  Double_t   fMassLo, fMassHi;                       // template mass range
+  Int_t      fNmPass, fNmFail;                       // number of mass bins, pass and fail
+  std::vector<CProbeStore> fStores;                  // (charge x projection) template sums
+};
+
+class CTemplateStore
+{
+public:
+  CTemplateStore(const TString &fname, const TString &prefix=""):fName(fname),fPrefix(prefix),fFile(0){}
+  ~CTemplateStore() { delete fFile; }
+
+  // Inputs key of the store in fname, empty if there is no (readable) store
+  static TString inputs(const TString &fname) {
+    if(gSystem->AccessPathName(fname)) return "";
+    TFile f(fname);
+    TNamed *key = f.IsZombie() ? 0 : (TNamed*)f.Get("Inputs");
+    return key ? TString(key->GetTitle()) : TString("");
+  }
+
+  // template of bin ibin of projection proj ("pt", "etapt", ...), owned by the store
+  TH1D* get(const TString &proj, const Int_t ibin, const Bool_t pass, const Int_t charge=0) {
+    open();
+    const Int_t iproj = templates::projIndex(proj);
+    assert(iproj>=0);
+    const Int_t icharge = templates::chargeIndex(charge);
+    assert(ibin>=0 && ibin<fNbins[icharge*templates::kNProj+iproj]);
+    const TString hname = TString(templates::chargeDir(icharge)) + "/" + templates::histName(fPrefix,iproj,ibin,pass);
+    TH1D *h = (TH1D*)fFile->Get(hname);
+    assert(h);
+    return h;
+  }
+
+  // number of bins of projection proj in the store
+  Int_t nbins(const TString &proj, const Int_t charge=0) {
+    open();
+    const Int_t iproj = templates::projIndex(proj);
+    return (iproj<0) ? 0 : fNbins[templates::chargeIndex(charge)*templates::kNProj+iproj];
+  }
+
+protected:
+  // open the file and read the index (bins per charge and projection) on first use
+  void open() {
+    if(fFile) return;
+    fFile = new TFile(fName);
+    assert(!fFile->IsZombie());
+    TTree *index = (TTree*)fFile->Get("Index");
+    assert(index);
+    Int_t charge, proj, ibin;
+    index->SetBranchAddress("charge", &charge);
+    index->SetBranchAddress("proj",   &proj);
+    index->SetBranchAddress("ibin",   &ibin);
+    fNbins.assign(templates::kNCharge*templates::kNProj, 0);
+    for(Long64_t i=0; i<index->GetEntries(); i++) {
+      index->GetEntry(i);
+      Int_t &n = fNbins[charge*templates::kNProj+proj];
+      if(ibin>=n) n = ibin+1;
+    }
+    delete index;
+  }
+
+  TString fName;               // store file name
+  TString fPrefix;             // histogram name prefix
+  TFile  *fFile;               // store file, opened on first use
+  std::vector<Int_t> fNbins;   // (charge x projection) number of bins
+};
+
+#endif
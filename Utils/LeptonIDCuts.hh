@@ -17,11 +17,29 @@ Bool_t passEleTightID(const baconhep::TElectron *electron, const Double_t rho);
 Bool_t passEleLooseID(const baconhep::TElectron *electron, const Double_t rho=0);
 Bool_t passAntiEleID(const baconhep::TElectron *electron, const Double_t rho=0);
 
-Bool_t isMuonTrigger(baconhep::TTrigger triggerMenu, TriggerBits hltBits);
-Bool_t isMuonTriggerObj(baconhep::TTrigger triggerMenu, TriggerObjects hltMatchBits, Bool_t isL1);
-
-Bool_t isEleTrigger(baconhep::TTrigger triggerMenu, TriggerBits hltBits, Bool_t isData);
-Bool_t isEleTriggerObj(baconhep::TTrigger triggerMenu, TriggerObjects hltMatchBits, Bool_t isL1, Bool_t isData);
+Bool_t isMuonTrigger(const baconhep::TTrigger &triggerMenu, const TriggerBits &hltBits);
+Bool_t isMuonTriggerObj(const baconhep::TTrigger &triggerMenu, const TriggerObjects &hltMatchBits, Bool_t isL1);
+
+Bool_t isEleTrigger(const baconhep::TTrigger &triggerMenu, const TriggerBits &hltBits, Bool_t isData);
+Bool_t isEleTriggerObj(const baconhep::TTrigger &triggerMenu, const TriggerObjects &hltMatchBits, Bool_t isL1, Bool_t isData);
+
+// trigger paths and filters above resolved once per job into bit masks, so the per-event and
+// per-lepton checks are a bitwise and (no name lookups)
+struct TriggerMasks {
+  TriggerBits    muon, ele;          // HLT paths
+  TriggerObjects muonObj[2];         // muon filters [isL1]
+  TriggerObjects eleObj[2][2];       // electron filters [isData][isL1]
+};
+TriggerMasks resolveTriggerMasks(const baconhep::TTrigger &triggerMenu);
+
+inline Bool_t isMuonTrigger(const TriggerMasks &masks, const TriggerBits &hltBits) { return (hltBits & masks.muon).any(); }
+inline Bool_t isMuonTriggerObj(const TriggerMasks &masks, const TriggerObjects &hltMatchBits, Bool_t isL1) {
+  return (hltMatchBits & masks.muonObj[isL1 ? 1 : 0]).any();
+}
+inline Bool_t isEleTrigger(const TriggerMasks &masks, const TriggerBits &hltBits, Bool_t) { return (hltBits & masks.ele).any(); }
+inline Bool_t isEleTriggerObj(const TriggerMasks &masks, const TriggerObjects &hltMatchBits, Bool_t isL1, Bool_t isData) {
+  return (hltMatchBits & masks.eleObj[isData ? 1 : 0][isL1 ? 1 : 0]).any();
+}
 
 Double_t getEffAreaEl(const Double_t eta);
 Double_t getEffAreaMu(const Double_t eta);
@@ -255,16 +273,16 @@ Bool_t passEleLooseID(const baconhep::TElectron *electron, const Double_t rho)
 }
 
 //--------------------------------------------------------------------------------------------------
-Bool_t isMuonTrigger(baconhep::TTrigger triggerMenu, TriggerBits hltBits) {
+Bool_t isMuonTrigger(const baconhep::TTrigger &triggerMenu, const TriggerBits &hltBits) {
   return triggerMenu.pass("HLT_IsoMu20_v*",hltBits);
 }
 
-Bool_t isMuonTriggerObj(baconhep::TTrigger triggerMenu, TriggerObjects hltMatchBits, Bool_t isL1) {
+Bool_t isMuonTriggerObj(const baconhep::TTrigger &triggerMenu, const TriggerObjects &hltMatchBits, Bool_t isL1) {
   if (isL1) return triggerMenu.passObj("HLT_IsoMu20_v*","hltL1sL1SingleMu16",hltMatchBits);
   else return triggerMenu.passObj("HLT_IsoMu20_v*","hltL3crIsoL1sMu16L1f0L2f10QL3f20QL3trkIsoFiltered0p09",hltMatchBits);
 }
 
-Bool_t isEleTrigger(baconhep::TTrigger triggerMenu, TriggerBits hltBits, Bool_t isData) {
+Bool_t isEleTrigger(const baconhep::TTrigger &triggerMenu, const TriggerBits &hltBits, Bool_t isData) {
   if (isData) {
     return triggerMenu.pass("HLT_Ele23_WPLoose_Gsf_v*",hltBits);
   }
@@ -273,7 +291,7 @@ Bool_t isEleTrigger(baconhep::TTrigger triggerMenu, TriggerBits hltBits, Bool_t
   }
 }
 
-Bool_t isEleTriggerObj(baconhep::TTrigger triggerMenu, TriggerObjects hltMatchBits, Bool_t isL1, Bool_t isData) {
+Bool_t isEleTriggerObj(const baconhep::TTrigger &triggerMenu, const TriggerObjects &hltMatchBits, Bool_t isL1, Bool_t isData) {
   if (isData) {
     if (isL1) {
       return triggerMenu.passObj("HLT_Ele23_WPLoose_Gsf_v*","hltEGL1SingleEG20ORL1SingleEG15Filter",hltMatchBits);
@@ -290,6 +308,30 @@ Bool_t isEleTriggerObj(baconhep::TTrigger triggerMenu, TriggerObjects hltMatchBi
   }
 }
 
+//--------------------------------------------------------------------------------------------------
+TriggerMasks resolveTriggerMasks(const baconhep::TTrigger &triggerMenu) {
+  // same paths and filters as the name based functions; a name missing from the menu leaves
+  // its mask empty, so the check fails as pass()/passObj() do
+  TriggerMasks masks;
+  const int muBit  = triggerMenu.getTriggerBit("HLT_IsoMu20_v*");
+  const int eleBit = triggerMenu.getTriggerBit("HLT_Ele23_WPLoose_Gsf_v*");
+  if(muBit>=0)  masks.muon.set(muBit);
+  if(eleBit>=0) masks.ele.set(eleBit);
+
+  const char *muFilters[2] = { "hltL3crIsoL1sMu16L1f0L2f10QL3f20QL3trkIsoFiltered0p09", "hltL1sL1SingleMu16" };
+  const char *eleFilters[2][2] = { { "hltEle23WPLooseGsfTrackIsoFilter", "hltL1sL1SingleEG20" },                      // MC
+                                   { "hltEle23WPLooseGsfTrackIsoFilter", "hltEGL1SingleEG20ORL1SingleEG15Filter" } }; // data
+  for(Int_t isL1=0; isL1<2; isL1++) {
+    const int bit = triggerMenu.getTriggerObjectBit("HLT_IsoMu20_v*", muFilters[isL1]);
+    if(bit>=0) masks.muonObj[isL1].set(bit);
+    for(Int_t isData=0; isData<2; isData++) {
+      const int ebit = triggerMenu.getTriggerObjectBit("HLT_Ele23_WPLoose_Gsf_v*", eleFilters[isData][isL1]);
+      if(ebit>=0) masks.eleObj[isData][isL1].set(ebit);
+    }
+  }
+  return masks;
+}
+
 //--------------------------------------------------------------------------------------------------
 Double_t getEffAreaEl(const Double_t eta) {
   if      (fabs(eta) < 0.8) return 0.1013;
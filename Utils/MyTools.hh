@@ -2,6 +2,9 @@
 #define MYTOOLS_HH
 
 #include <iostream>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
 #include "TLorentzVector.h"
 #include "TClonesArray.h"
 #include "BaconAna/DataFormats/interface/TGenParticle.hh"
@@ -17,6 +20,36 @@ namespace toolbox
   
   void fillGen(TClonesArray *genPartArr, Int_t vid, TLorentzVector* &vec, TLorentzVector* &lep1, TLorentzVector* &lep2, Int_t* lep1q, Int_t* lep2q, Int_t absM);
 
+  //
+  // gen record of one event decoded in a single pass into caller-owned PODs, no allocation per event:
+  // the boson, the leptons as they leave the boson (pre-FSR) and at the end of their decay chain,
+  // their charges and the flavor of toolbox::flavor()
+  //
+  struct GenKin {
+    Double_t pt, eta, phi, m;
+    void set(const baconhep::TGenParticle *p) { pt=p->pt; eta=p->eta; phi=p->phi; m=p->mass; }
+    TLorentzVector p4() const { TLorentzVector v; v.SetPtEtaPhiM(pt,eta,phi,m); return v; }
+  };
+
+  struct GenDecay {
+    Int_t  flavor;                    // pdgId of the first lepton from the boson (0 if none)
+    Bool_t hasBoson;                  // boson found, or made from the two pre-FSR leptons
+    GenKin boson;
+    Int_t  nlep;                      // leptons found (0-2)
+    GenKin lep1, lep2;                // end of the lepton chains, leading lepton first (zero if not found:
+                                      // eta=phi=0, so check nlep before matching)
+    GenKin preLep1, preLep2;          // same leptons as they leave the boson
+    Int_t  lep1q, lep2q;              // charges (0 if not found)
+  };
+
+  class GenDecoder {
+  public:
+    GenDecoder(){}
+    // decode genPartArr for boson vid (absM: match |pdgId|)
+    void decode(TClonesArray *genPartArr, Int_t vid, Int_t absM, GenDecay &out);
+  protected:
+    std::vector<Int_t> fAbsPdg;       // |pdgId| per particle, reused between events for the parent lookups
+  };
 }
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -54,115 +87,98 @@ Int_t toolbox::roundToInt(Double_t x)
 }
 
 //------------------------------------------------------------------------------------------------------------------------
-Int_t toolbox::flavor(TClonesArray *genPartArr, Int_t vid) {
-
-  for (Int_t i=0; i<genPartArr->GetEntries(); i++) {
-    const baconhep::TGenParticle* genloop = (baconhep::TGenParticle*) ((*genPartArr)[i]);
-    Int_t pdgId=fabs(genloop->pdgId);
-    Int_t parentPdgId=fabs(dynamic_cast<baconhep::TGenParticle*>(genPartArr->At(genloop->parent>-1 ? genloop->parent : 0))->pdgId);
-    if ( (pdgId==11||pdgId==13||pdgId==15) && (parentPdgId==fabs(vid) || genloop->status==23) ) return genloop->pdgId;
-  }
-  return 0;
-}
-
-//------------------------------------------------------------------------------------------------------------------------
-void toolbox::fillGen(TClonesArray *genPartArr, Int_t vid, TLorentzVector* &vec, TLorentzVector* &lep1, TLorentzVector* &lep2, Int_t* lep1q, Int_t* lep2q, Int_t absM) 
+void toolbox::GenDecoder::decode(TClonesArray *genPartArr, Int_t vid, Int_t absM, GenDecay &out)
 {
+  memset(&out, 0, sizeof(out));
+  const Int_t n = genPartArr->GetEntriesFast();
+  if((Int_t)fAbsPdg.size()<n) fAbsPdg.resize(n);
+
+  // iv, iv1, iv2: current end of the boson, positive and negative lepton chains
   Int_t iv=-1, iv1=-1, iv2=-1;
-  TLorentzVector *lepPos=0, *lepNeg=0;
-  TLorentzVector *preLepPos=0, *preLepNeg=0;
-  for (Int_t i=0; i<genPartArr->GetEntries(); i++) {
-    const baconhep::TGenParticle* genloop = (baconhep::TGenParticle*) ((*genPartArr)[i]);
-    if (genloop->status==23 && (fabs(genloop->pdgId)==15 || fabs(genloop->pdgId)==13 || fabs(genloop->pdgId)==11)) {
-      if (genloop->pdgId<0 && lepPos==0) {
-	lepPos=new TLorentzVector(0,0,0,0);
-	lepPos->SetPtEtaPhiM(genloop->pt, genloop->eta, genloop->phi, genloop->mass);
-	preLepPos=new TLorentzVector(0,0,0,0);
-	preLepPos->SetPtEtaPhiM(genloop->pt, genloop->eta, genloop->phi, genloop->mass);
-	iv1=i;
-      }
-      else if (genloop->pdgId>0 && lepNeg==0) {
-	lepNeg=new TLorentzVector(0,0,0,0);
-	lepNeg->SetPtEtaPhiM(genloop->pt, genloop->eta, genloop->phi, genloop->mass);
-	preLepNeg=new TLorentzVector(0,0,0,0);
-	preLepNeg->SetPtEtaPhiM(genloop->pt, genloop->eta, genloop->phi, genloop->mass);
-	iv2=i;
-      }
+  GenKin lepPos, lepNeg, preLepPos, preLepNeg;
+  for(Int_t i=0; i<n; i++) {
+    const baconhep::TGenParticle *genloop = (const baconhep::TGenParticle*)genPartArr->UncheckedAt(i);
+    const Int_t pdgId    = genloop->pdgId;
+    const Int_t absPdgId = abs(pdgId);
+    fAbsPdg[i] = absPdgId;
+    const Bool_t isLep = (absPdgId==11 || absPdgId==13 || absPdgId==15);
+
+    // flavor: first lepton whose parent is the boson or with status 23 (no parent: particle 0)
+    if(out.flavor==0 && isLep) {
+      const Int_t ip = (genloop->parent>-1) ? genloop->parent : 0;
+      const Int_t parentAbsPdg = (ip<=i) ? fAbsPdg[ip] : abs(((const baconhep::TGenParticle*)genPartArr->UncheckedAt(ip))->pdgId);
+      if(parentAbsPdg==abs(vid) || genloop->status==23) out.flavor = pdgId;
     }
-    else if ((absM==0 && genloop->pdgId==vid && (genloop->status==3||genloop->status==22)) || (absM==1 && fabs(genloop->pdgId)==fabs(vid) && (genloop->status==3||genloop->status==22))) {
-      vec=new TLorentzVector(0,0,0,0);
-      vec->SetPtEtaPhiM(genloop->pt, genloop->eta, genloop->phi, genloop->mass);
+
+    const Bool_t isBoson = (absM==0) ? (pdgId==vid) : (absPdgId==abs(vid));
+    if(genloop->status==23 && isLep) {
+      if(pdgId<0 && iv1==-1)      { lepPos.set(genloop); preLepPos=lepPos; iv1=i; }
+      else if(pdgId>0 && iv2==-1) { lepNeg.set(genloop); preLepNeg=lepNeg; iv2=i; }
+    }
+    else if(isBoson && (genloop->status==3 || genloop->status==22)) {
+      out.boson.set(genloop);
+      out.hasBoson = kTRUE;
       iv=i;
     }
-    else if (iv!=-1 && genloop->parent==iv) {
-      if ((absM==0 && genloop->pdgId==vid)||(absM==1 && fabs(genloop->pdgId)==fabs(vid))) {
-	vec->SetPtEtaPhiM(genloop->pt, genloop->eta, genloop->phi, genloop->mass);
+    else if(iv!=-1 && genloop->parent==iv) {
+      if(isBoson) {
+        out.boson.set(genloop);
         iv=i;
       }
-      else if (fabs(genloop->pdgId)==15 || fabs(genloop->pdgId)==13 || fabs(genloop->pdgId)==11) {
-	if (genloop->pdgId<0 && lepPos==0) {
-          lepPos=new TLorentzVector(0,0,0,0);
-          lepPos->SetPtEtaPhiM(genloop->pt, genloop->eta, genloop->phi, genloop->mass);
-	  preLepPos=new TLorentzVector(0,0,0,0);
-	  preLepPos->SetPtEtaPhiM(genloop->pt, genloop->eta, genloop->phi, genloop->mass);
-          iv1=i;
-	}
-	else if (genloop->pdgId>0 && lepNeg==0) {
-          lepNeg=new TLorentzVector(0,0,0,0);
-          lepNeg->SetPtEtaPhiM(genloop->pt, genloop->eta, genloop->phi, genloop->mass);
-	  preLepNeg=new TLorentzVector(0,0,0,0);
-	  preLepNeg->SetPtEtaPhiM(genloop->pt, genloop->eta, genloop->phi, genloop->mass);
-          iv2=i;
-	}
+      else if(isLep) {
+        if(pdgId<0 && iv1==-1)      { lepPos.set(genloop); preLepPos=lepPos; iv1=i; }
+        else if(pdgId>0 && iv2==-1) { lepNeg.set(genloop); preLepNeg=lepNeg; iv2=i; }
       }
     }
-    else if (iv1!=-1 && genloop->parent==iv1) {
-      lepPos->SetPtEtaPhiM(genloop->pt, genloop->eta, genloop->phi, genloop->mass);
-      iv1=i;
-    }
-    else if (iv2!=-1 && genloop->parent==iv2) {
-      lepNeg->SetPtEtaPhiM(genloop->pt, genloop->eta, genloop->phi, genloop->mass);
-      iv2=i;
-    }
+    else if(iv1!=-1 && genloop->parent==iv1) { lepPos.set(genloop); iv1=i; }
+    else if(iv2!=-1 && genloop->parent==iv2) { lepNeg.set(genloop); iv2=i; }
   }
 
-  if (vec==0 && preLepNeg && preLepPos) {
-    TLorentzVector temp = *preLepNeg + *preLepPos;
-    vec->SetPtEtaPhiM(temp.Pt(), temp.Eta(), temp.Phi(), temp.M());
+  if(!out.hasBoson && iv1!=-1 && iv2!=-1) {
+    const TLorentzVector temp = preLepPos.p4() + preLepNeg.p4();
+    out.boson.pt = temp.Pt(); out.boson.eta = temp.Eta(); out.boson.phi = temp.Phi(); out.boson.m = temp.M();
+    out.hasBoson = kTRUE;
   }
 
-  if (lepPos && lepNeg) {
-    if (lepPos->Pt()>lepNeg->Pt()) {
-      lep1->SetPtEtaPhiM(lepPos->Pt(), lepPos->Eta(), lepPos->Phi(), lepPos->M());
-      lep2->SetPtEtaPhiM(lepNeg->Pt(), lepNeg->Eta(), lepNeg->Phi(), lepNeg->M());
-      *lep1q=1;
-      *lep2q=-1;
-    }
-    else {
-      lep1->SetPtEtaPhiM(lepNeg->Pt(), lepNeg->Eta(), lepNeg->Phi(), lepNeg->M());
-      lep2->SetPtEtaPhiM(lepPos->Pt(), lepPos->Eta(), lepPos->Phi(), lepPos->M());
-      *lep1q=-1;
-      *lep2q=1;
-    }
+  if(iv1!=-1 && iv2!=-1) {
+    const Bool_t posLeads = (lepPos.pt>lepNeg.pt);
+    out.nlep    = 2;
+    out.lep1    = posLeads ? lepPos : lepNeg;        out.lep2    = posLeads ? lepNeg : lepPos;
+    out.preLep1 = posLeads ? preLepPos : preLepNeg;  out.preLep2 = posLeads ? preLepNeg : preLepPos;
+    out.lep1q   = posLeads ? 1 : -1;                 out.lep2q   = -out.lep1q;
   }
-  else if (lepPos) 
-    {
-      lep1->SetPtEtaPhiM(lepPos->Pt(), lepPos->Eta(), lepPos->Phi(), lepPos->M());
-      *lep1q=1;
-    }
-  else if (lepNeg)
-    {
-      lep1->SetPtEtaPhiM(lepNeg->Pt(), lepNeg->Eta(), lepNeg->Phi(), lepNeg->M());
-      *lep1q=-1;
-    }
+  else if(iv1!=-1) { out.nlep=1; out.lep1=lepPos; out.preLep1=preLepPos; out.lep1q= 1; }
+  else if(iv2!=-1) { out.nlep=1; out.lep1=lepNeg; out.preLep1=preLepNeg; out.lep1q=-1; }
+}
 
-  delete preLepNeg;
-  delete preLepPos;
-  delete lepNeg;
-  delete lepPos;
-  
-  preLepNeg=0; preLepPos=0;
-  lepNeg=0; lepPos=0;
+//------------------------------------------------------------------------------------------------------------------------
+Int_t toolbox::flavor(TClonesArray *genPartArr, Int_t vid)
+{
+  static GenDecoder decoder;
+  GenDecay decay;
+  decoder.decode(genPartArr, vid, 1, decay);
+  return decay.flavor;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+void toolbox::fillGen(TClonesArray *genPartArr, Int_t vid, TLorentzVector* &vec, TLorentzVector* &lep1, TLorentzVector* &lep2, Int_t* lep1q, Int_t* lep2q, Int_t absM) 
+{
+  // the vectors are filled in place; vec is only allocated if the caller passes none
+  static GenDecoder decoder;
+  GenDecay decay;
+  decoder.decode(genPartArr, vid, absM, decay);
 
+  if(decay.hasBoson) {
+    if(!vec) vec = new TLorentzVector(0,0,0,0);
+    vec->SetPtEtaPhiM(decay.boson.pt, decay.boson.eta, decay.boson.phi, decay.boson.m);
+  }
+  if(decay.nlep>0) {
+    lep1->SetPtEtaPhiM(decay.lep1.pt, decay.lep1.eta, decay.lep1.phi, decay.lep1.m);
+    *lep1q = decay.lep1q;
   }
+  if(decay.nlep>1) {
+    lep2->SetPtEtaPhiM(decay.lep2.pt, decay.lep2.eta, decay.lep2.phi, decay.lep2.m);
+    *lep2q = decay.lep2q;
+  }
+}
 #endif
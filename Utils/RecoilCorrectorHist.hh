@@ -0,0 +1,254 @@
+#ifndef RECOILCORRECTORHIST_HH
+#define RECOILCORRECTORHIST_HH
+//================================================================================================
+//
+// Histogram based recoil corrections (quantile mapping)
+//
+//  * RecoilCorrectorHist reads the u1 and u2 distributions of each boson pT bin that the recoil fit
+//    macros save next to the fits (hPFu1_<bin>, hPFu2_<bin> and the bin edges "ptbins") and
+//    precomputes per bin and component:
+//      - the inverse CDF of the target (e.g. Z data) at kNQ+1 equidistant probabilities, and the
+//        statistical uncertainty of each quantile, sqrt(p(1-p)/Neff) dQ/dp
+//      - the CDF of the source (e.g. Z MC) at its histogram bin edges, if a source file is given
+//  * Correct() and CorrectVariations() take the arguments of RecoilCorrector and draw u1, u2 from the
+//    target quantiles; CorrectType2() instead maps the recoil of the MC event, u -> Q_target(F_source(u))
+//  * a correction is a pT bin lookup and linear interpolation in the tables: no TF1 evaluations and
+//    no rejection sampling; nsigma shifts the quantiles by their statistical uncertainty
+//
+//________________________________________________________________________________________________
+
+#include <TFile.h>
+#include <TH1D.h>
+#include <TMath.h>
+#include <TRandom.h>
+#include <TString.h>
+#include <TVectorD.h>
+#include <vector>
+#include <iostream>
+#include <cassert>
+
+#include "CBinning.hh"              // fast bin lookup
+#include "CEventRandom.hh"          // counter-based random numbers
+
+//--------------------------------------------------------------------------------------------------
+class RecoilCorrectorHist
+{
+public:
+  RecoilCorrectorHist(TString fname,          // recoil fits with the per-bin distributions to correct to (e.g. Z data)
+                      TString fnameMC="",     // same for the simulation to correct from (e.g. Z MC), for CorrectType2()
+                      Int_t iSeed=0xDEADBEEF);  // seed for random number generator
+  ~RecoilCorrectorHist(){}
+
+  void Correct(Double_t &pfmet, Double_t &pfmetphi,  // reference to variables to store corrected MET and phi(MET)
+               Double_t genWPt, Double_t genWPhi,    // GEN W boson pT and phi
+               Double_t lepPt,  Double_t lepPhi,     // lepton pT and phi
+               Double_t nsigma,                      // # of sigmas on the quantile uncertainties (0 = nominal correction)
+               Int_t charge);                        // lepton charge (not used)
+
+  // correct one event for nvar variations at once (same random numbers for all variations)
+  void CorrectVariations(const UInt_t nvar,
+                         Double_t *pfmet, Double_t *pfmetphi,           // arrays of nvar to store corrected MET and phi(MET)
+                         const Double_t genWPt, const Double_t genWPhi, // GEN W boson pT and phi
+                         const Double_t *lepPt, const Double_t lepPhi,  // lepton pT for each variation, lepton phi
+                         const Double_t *nsigma,                        // # of sigmas on the quantile uncertainties for each variation
+                         const Int_t charge,                            // lepton charge (not used)
+                         const ULong64_t evtId);                        // event identifier for the random numbers
+
+  // map the recoil of the event (from the input MET and the GEN lepton) through the source CDF and
+  // target quantiles; the corrected u1, u2 are returned in iU1, iU2
+  void CorrectType2(Double_t &pfmet, Double_t &pfmetphi,
+                    Double_t genWPt, Double_t genWPhi,
+                    Double_t lepPt,  Double_t lepPhi,
+                    Double_t &iU1,   Double_t &iU2,
+                    Double_t nsigmaU1, Double_t nsigmaU2=0);  // # of sigmas on the u1 and u2 quantile uncertainties
+
+protected:
+  enum { kU1=0, kU2, kNComp };
+  enum { kNQ=2000 };  // fine enough to resolve the tails (p < 1/kNQ is interpolated to the edge)
+
+  struct Table {
+    std::vector<Double_t> q, dq;   // target quantiles and their uncertainties at p = j/kNQ
+    Double_t lo, invWidth;         // source histogram range
+    std::vector<Double_t> cdf;     // source CDF at the histogram bin edges
+  };
+
+  void     readTables(const TString &fname, const Bool_t isSource);
+  Int_t    ptBin(const CBinning &bins, const Double_t pt) const;
+  Double_t quantile(const Table &t, const Double_t p, const Double_t nsigma) const;
+  Double_t cdf(const Table &t, const Double_t u) const;
+  void     makeMet(Double_t &pfmet, Double_t &pfmetphi, const Double_t pfu1, const Double_t pfu2,
+                   const Double_t genWPhi, const Double_t lepPt, const Double_t lepPhi) const;
+  Double_t uniform(const ULong64_t evtId, const UInt_t k) const { return CEventRandom::uniform(fSeed,evtId,k); }
+
+  CBinning fPtBins, fPtBinsMC;              // boson pT bins of the target and source tables
+  std::vector<Table> fTables[kNComp];       // target tables per pT bin
+  std::vector<Table> fTablesMC[kNComp];     // source tables per pT bin
+  ULong64_t fSeed;                          // seed for CorrectVariations random numbers
+};
+
+//==================================================================================================
+
+RecoilCorrectorHist::RecoilCorrectorHist(TString fname, TString fnameMC, Int_t seed)
+{
+  gRandom->SetSeed(seed);
+  fSeed = seed;
+  readTables(fname, kFALSE);
+  if(fnameMC.Length()>0) readTables(fnameMC, kTRUE);
+}
+
+//--------------------------------------------------------------------------------------------------
+void RecoilCorrectorHist::readTables(const TString &fname, const Bool_t isSource)
+{
+  TFile infile(fname);
+  assert(!infile.IsZombie());
+  TVectorD *ptbins = (TVectorD*)infile.Get("ptbins");
+  if(!ptbins) {
+    std::cout << "No per-bin recoil distributions in " << fname << ", rerun the recoil fits! Aborting..." << std::endl;
+    assert(0);
+  }
+  std::vector<Double_t> edgesv(ptbins->GetMatrixArray(), ptbins->GetMatrixArray()+ptbins->GetNoElements());
+  delete ptbins;
+  (isSource ? fPtBinsMC : fPtBins).init(edgesv, kFALSE, kTRUE);  // (lo,hi] as in the recoil fits
+
+  const Int_t nbins = edgesv.size()-1;
+  for(Int_t icomp=0; icomp<kNComp; icomp++) {
+    std::vector<Table> &tables = isSource ? fTablesMC[icomp] : fTables[icomp];
+    tables.resize(nbins);
+    for(Int_t ibin=0; ibin<nbins; ibin++) {
+      TH1D *h = (TH1D*)infile.Get(TString::Format("hPF%s_%i", (icomp==kU1) ? "u1" : "u2", ibin));
+      assert(h);
+      Table &t = tables[ibin];
+      const Int_t nb = h->GetNbinsX();
+
+      // CDF at the bin edges (under- and overflow are not used, as in the fits)
+      std::vector<Double_t> c(nb+1, 0);
+      for(Int_t k=0; k<nb; k++) c[k+1] = c[k] + TMath::Max(h->GetBinContent(k+1), 0.);
+      assert(c[nb]>0);
+      for(Int_t k=0; k<=nb; k++) c[k] /= c[nb];
+
+      if(isSource) {
+        t.lo       = h->GetXaxis()->GetXmin();
+        t.invWidth = nb/(h->GetXaxis()->GetXmax() - t.lo);
+        t.cdf      = c;
+
+      } else {
+        // quantiles: invert the piecewise linear CDF at p = j/kNQ
+        t.q.resize(kNQ+1);
+        Int_t k=0;
+        for(Int_t j=0; j<=kNQ; j++) {
+          const Double_t p = Double_t(j)/kNQ;
+          while(k<nb-1 && c[k+1]<p) k++;
+          while(k<nb-1 && c[k+1]==c[k]) k++;  // empty bins
+          const Double_t lo = h->GetXaxis()->GetBinLowEdge(k+1);
+          const Double_t w  = h->GetXaxis()->GetBinWidth(k+1);
+          t.q[j] = (c[k+1]>c[k]) ? lo + w*TMath::Min(TMath::Max((p-c[k])/(c[k+1]-c[k]), 0.), 1.) : lo;
+        }
+        // statistical uncertainty of the quantiles
+        const Double_t neff = TMath::Max(h->GetEffectiveEntries(), 1.);
+        t.dq.resize(kNQ+1);
+        for(Int_t j=0; j<=kNQ; j++) {
+          const Double_t p    = Double_t(j)/kNQ;
+          const Int_t    jlo  = TMath::Max(j-1, 0), jhi = TMath::Min(j+1, Int_t(kNQ));
+          const Double_t dqdp = (t.q[jhi]-t.q[jlo])*kNQ/(jhi-jlo);
+          t.dq[j] = TMath::Sqrt(p*(1-p)/neff)*dqdp;
+        }
+      }
+      delete h;
+    }
+  }
+  infile.Close();
+}
+
+//--------------------------------------------------------------------------------------------------
+Int_t RecoilCorrectorHist::ptBin(const CBinning &bins, const Double_t pt) const
+{
+  // values outside the binning use the first or last bin
+  const Int_t ipt = bins.find(pt);
+  if(ipt>=0) return ipt;
+  return (pt<=bins.lowEdge(0)) ? 0 : bins.nbins()-1;
+}
+
+//--------------------------------------------------------------------------------------------------
+Double_t RecoilCorrectorHist::quantile(const Table &t, const Double_t p, const Double_t nsigma) const
+{
+  const Double_t x = TMath::Min(TMath::Max(p, 0.), 1.)*kNQ;
+  const Int_t    j = TMath::Min(Int_t(x), kNQ-1);
+  const Double_t f = x - j;
+  return (t.q[j] + f*(t.q[j+1]-t.q[j])) + nsigma*(t.dq[j] + f*(t.dq[j+1]-t.dq[j]));
+}
+
+//--------------------------------------------------------------------------------------------------
+Double_t RecoilCorrectorHist::cdf(const Table &t, const Double_t u) const
+{
+  const Int_t    nb = t.cdf.size()-1;
+  const Double_t x  = TMath::Min(TMath::Max((u-t.lo)*t.invWidth, 0.), Double_t(nb));
+  const Int_t    k  = TMath::Min(Int_t(x), nb-1);
+  return t.cdf[k] + (x-k)*(t.cdf[k+1]-t.cdf[k]);
+}
+
+//--------------------------------------------------------------------------------------------------
+void RecoilCorrectorHist::makeMet(Double_t &pfmet, Double_t &pfmetphi, const Double_t pfu1, const Double_t pfu2,
+                                  const Double_t genWPhi, const Double_t lepPt, const Double_t lepPhi) const
+{
+  const Double_t cosV = TMath::Cos(genWPhi);
+  const Double_t sinV = TMath::Sin(genWPhi);
+  const Double_t metx = -pfu1*cosV + pfu2*sinV - lepPt*TMath::Cos(lepPhi);
+  const Double_t mety = -pfu1*sinV - pfu2*cosV - lepPt*TMath::Sin(lepPhi);
+  pfmet    = TMath::Sqrt(metx*metx + mety*mety);
+  pfmetphi = TMath::ATan2(mety,metx);
+}
+
+//--------------------------------------------------------------------------------------------------
+void RecoilCorrectorHist::Correct(Double_t &pfmet, Double_t &pfmetphi,
+                                  Double_t genWPt, Double_t genWPhi,
+                                  Double_t lepPt,  Double_t lepPhi,
+                                  Double_t nsigma, Int_t charge
+) {
+  const Int_t ipt = ptBin(fPtBins, genWPt);
+  const Double_t pfu1 = quantile(fTables[kU1][ipt], gRandom->Uniform(0,1), nsigma);
+  const Double_t pfu2 = quantile(fTables[kU2][ipt], gRandom->Uniform(0,1), nsigma);
+  makeMet(pfmet, pfmetphi, pfu1, pfu2, genWPhi, lepPt, lepPhi);
+}
+
+//--------------------------------------------------------------------------------------------------
+void RecoilCorrectorHist::CorrectVariations(const UInt_t nvar,
+                                            Double_t *pfmet, Double_t *pfmetphi,
+                                            const Double_t genWPt, const Double_t genWPhi,
+                                            const Double_t *lepPt, const Double_t lepPhi,
+                                            const Double_t *nsigma, const Int_t charge, const ULong64_t evtId
+) {
+  const Int_t    ipt = ptBin(fPtBins, genWPt);
+  const Double_t p1  = uniform(evtId,0);
+  const Double_t p2  = uniform(evtId,1);
+  for(UInt_t iv=0; iv<nvar; iv++) {
+    const Double_t pfu1 = quantile(fTables[kU1][ipt], p1, nsigma[iv]);
+    const Double_t pfu2 = quantile(fTables[kU2][ipt], p2, nsigma[iv]);
+    makeMet(pfmet[iv], pfmetphi[iv], pfu1, pfu2, genWPhi, lepPt[iv], lepPhi);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+void RecoilCorrectorHist::CorrectType2(Double_t &pfmet, Double_t &pfmetphi,
+                                       Double_t genWPt, Double_t genWPhi,
+                                       Double_t lepPt,  Double_t lepPhi,
+                                       Double_t &iU1,   Double_t &iU2,
+                                       Double_t nsigmaU1, Double_t nsigmaU2
+) {
+  assert(fTablesMC[kU1].size()>0);
+
+  // recoil of the event: U = -(MET + lepton), projected on the boson direction
+  const Double_t cosV = TMath::Cos(genWPhi);
+  const Double_t sinV = TMath::Sin(genWPhi);
+  const Double_t ux   = -pfmet*TMath::Cos(pfmetphi) - lepPt*TMath::Cos(lepPhi);
+  const Double_t uy   = -pfmet*TMath::Sin(pfmetphi) - lepPt*TMath::Sin(lepPhi);
+  const Double_t u1   =  ux*cosV + uy*sinV;
+  const Double_t u2   = -ux*sinV + uy*cosV;
+
+  const Int_t ipt   = ptBin(fPtBins,   genWPt);
+  const Int_t iptMC = ptBin(fPtBinsMC, genWPt);
+  iU1 = quantile(fTables[kU1][ipt], cdf(fTablesMC[kU1][iptMC], u1), nsigmaU1);
+  iU2 = quantile(fTables[kU2][ipt], cdf(fTablesMC[kU2][iptMC], u2), nsigmaU2);
+  makeMet(pfmet, pfmetphi, iU1, iU2, genWPhi, lepPt, lepPhi);
+}
+
+#endif